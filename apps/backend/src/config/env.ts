@@ -22,6 +22,7 @@ const envSchema = z.object({
   CLOUDINARY_CLOUD_NAME: z.string().optional(),
   CLOUDINARY_API_KEY: z.string().optional(),
   CLOUDINARY_API_SECRET: z.string().optional(),
+  MEDIA_UPLOAD_DIR: z.string().optional(),
 
   // Email
   RESEND_API_KEY: z.string().optional(),
@@ -147,6 +148,7 @@ export const env = {
   CLOUDINARY_CLOUD_NAME: normalizeOptionalString(parsed.CLOUDINARY_CLOUD_NAME),
   CLOUDINARY_API_KEY: normalizeOptionalString(parsed.CLOUDINARY_API_KEY),
   CLOUDINARY_API_SECRET: normalizeOptionalString(parsed.CLOUDINARY_API_SECRET),
+  MEDIA_UPLOAD_DIR: normalizeOptionalString(parsed.MEDIA_UPLOAD_DIR),
   REDIS_TLS: parseBoolean(parsed.REDIS_TLS, false),
   REDIS_KEY_PREFIX: parsed.REDIS_KEY_PREFIX ?? "prava",
   FCM_SERVER_KEY: normalizeOptionalString(parsed.FCM_SERVER_KEY),
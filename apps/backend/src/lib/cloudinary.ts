@@ -1,4 +1,7 @@
-import { v2 as cloudinary } from "cloudinary";
+import type { Readable, Writable } from "node:stream";
+import { pipeline } from "node:stream/promises";
+
+import { v2 as cloudinary, type UploadApiResponse } from "cloudinary";
 
 import { env } from "../config/env.js";
 
@@ -37,19 +40,14 @@ export interface UploadResult {
   bytes: number | null;
 }
 
-export async function uploadMedia(
-  file: string | Buffer,
-  options: {
-    folder?: string;
-    resourceType?: "image" | "video" | "raw" | "auto";
-    transformation?: object[];
-    publicId?: string;
-  } = {}
-): Promise<UploadResult> {
-  if (!configured) {
-    throw new Error("Cloudinary is not configured");
-  }
+export interface UploadOptions {
+  folder?: string;
+  resourceType?: "image" | "video" | "raw" | "auto";
+  transformation?: object[];
+  publicId?: string;
+}
 
+function buildUploadOptions(options: UploadOptions): Record<string, unknown> {
   const uploadOptions: Record<string, unknown> = {
     folder: options.folder || "prava",
     resource_type: options.resourceType || "auto",
@@ -65,11 +63,10 @@ export async function uploadMedia(
     uploadOptions.public_id = options.publicId;
   }
 
-  const result = await cloudinary.uploader.upload(
-    typeof file === "string" ? file : `data:application/octet-stream;base64,${file.toString("base64")}`,
-    uploadOptions
-  );
+  return uploadOptions;
+}
 
+function mapUploadResult(result: UploadApiResponse): UploadResult {
   return {
     assetId: result.asset_id || result.public_id,
     publicId: result.public_id,
@@ -83,6 +80,52 @@ export async function uploadMedia(
   };
 }
 
+export async function uploadMedia(
+  file: string | Buffer,
+  options: UploadOptions = {}
+): Promise<UploadResult> {
+  if (!configured) {
+    throw new Error("Cloudinary is not configured");
+  }
+
+  const result = await cloudinary.uploader.upload(
+    typeof file === "string" ? file : `data:application/octet-stream;base64,${file.toString("base64")}`,
+    buildUploadOptions(options)
+  );
+
+  return mapUploadResult(result);
+}
+
+/**
+ * Upload from a stream without holding the file in memory (used to assemble
+ * chunked uploads straight from disk).
+ */
+export async function uploadMediaStream(
+  source: Readable,
+  options: UploadOptions = {}
+): Promise<UploadResult> {
+  if (!configured) {
+    throw new Error("Cloudinary is not configured");
+  }
+
+  let destination!: Writable;
+  const uploaded = new Promise<UploadApiResponse>((resolve, reject) => {
+    destination = cloudinary.uploader.upload_stream(
+      buildUploadOptions(options),
+      (error, result) => {
+        if (error || !result) {
+          reject(error || new Error("Cloudinary upload failed"));
+          return;
+        }
+        resolve(result);
+      }
+    );
+  });
+
+  const [, result] = await Promise.all([pipeline(source, destination), uploaded]);
+  return mapUploadResult(result);
+}
+
 export async function deleteMedia(publicId: string, resourceType = "image"): Promise<boolean> {
   if (!configured) {
     return false;
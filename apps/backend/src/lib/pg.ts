@@ -1030,6 +1030,7 @@ export async function runMigrations(p: pg.Pool): Promise<void> {
     );
     ALTER TABLE messages ADD COLUMN IF NOT EXISTS client_message_id UUID DEFAULT NULL;
     CREATE INDEX IF NOT EXISTS idx_messages_conv_created ON messages (conversation_id, created_at DESC);
+    CREATE INDEX IF NOT EXISTS idx_messages_media_asset ON messages (media_asset_id) WHERE media_asset_id IS NOT NULL;
     CREATE UNIQUE INDEX IF NOT EXISTS idx_messages_legacy_client_dedupe
       ON messages (conversation_id, sender_user_id, client_message_id)
       WHERE client_message_id IS NOT NULL;
@@ -1237,6 +1238,35 @@ export async function runMigrations(p: pg.Pool): Promise<void> {
       created_at      TIMESTAMPTZ NOT NULL DEFAULT NOW()
     );
     CREATE INDEX IF NOT EXISTS idx_media_user ON media_assets (user_id, created_at DESC);
+    ALTER TABLE media_assets ADD COLUMN IF NOT EXISTS content_hash TEXT DEFAULT NULL;
+    CREATE INDEX IF NOT EXISTS idx_media_user_content_hash ON media_assets (user_id, content_hash);
+
+    -- RESUMABLE MEDIA UPLOADS (content-addressed chunks)
+    CREATE TABLE IF NOT EXISTS media_uploads (
+      upload_id       TEXT PRIMARY KEY,
+      user_id         TEXT NOT NULL REFERENCES users(user_id) ON DELETE CASCADE,
+      content_hash    TEXT NOT NULL,
+      total_bytes     BIGINT NOT NULL,
+      chunk_size      INT NOT NULL,
+      chunk_hashes    JSONB NOT NULL DEFAULT '[]',
+      resource_type   TEXT NOT NULL DEFAULT 'auto',
+      folder          TEXT NOT NULL DEFAULT '',
+      context         TEXT NOT NULL DEFAULT 'general',
+      status          TEXT NOT NULL DEFAULT 'pending',
+      created_at      TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+      updated_at      TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+      expires_at      TIMESTAMPTZ NOT NULL
+    );
+    CREATE INDEX IF NOT EXISTS idx_media_uploads_user_hash ON media_uploads (user_id, content_hash);
+    CREATE INDEX IF NOT EXISTS idx_media_uploads_expires ON media_uploads (expires_at);
+
+    CREATE TABLE IF NOT EXISTS media_upload_chunks (
+      upload_id       TEXT NOT NULL REFERENCES media_uploads(upload_id) ON DELETE CASCADE,
+      chunk_index     INT NOT NULL,
+      bytes           INT NOT NULL,
+      received_at     TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+      PRIMARY KEY (upload_id, chunk_index)
+    );
 
     CREATE TABLE IF NOT EXISTS chat_attachments (
       attachment_id   TEXT PRIMARY KEY,
@@ -0,0 +1,132 @@
+import { queryMany } from "../../lib/pg.js";
+import { mapMessage, mapReaction } from "./store.js";
+
+// Message rows with their media asset joined in the same statement, under the
+// column names mapMessage() reads (hydrateMessageMedia does the same as a
+// second query).
+const HISTORY_SELECT = `SELECT m.*,
+         ma.secure_url AS media_secure_url,
+         ma.url AS media_url,
+         ma.resource_type AS media_resource_type,
+         ma.width AS media_width,
+         ma.height AS media_height,
+         ma.bytes AS media_bytes
+       FROM messages m
+       LEFT JOIN media_assets ma ON ma.asset_id = m.media_asset_id`;
+
+// Upper bound on conversations in one delta sync request.
+export const MAX_SYNC_CONVERSATIONS = 200;
+
+export type HistoryWindow = {
+  conversationId: string;
+  // Exclusive lower bound (last seq the client has, or the clear point).
+  afterSeq: number;
+  // Inclusive upper bound.
+  untilSeq: number;
+};
+
+/**
+ * Map rows sorted by (conversation_id, seq) and attach their reactions.
+ *
+ * Reactions are read in the same order, so both lists are walked once with
+ * a cursor each instead of being grouped through a map.
+ */
+async function mapSortedMessages(rows: any[]): Promise<any[]> {
+  if (rows.length === 0) {
+    return [];
+  }
+
+  const reactions = await queryMany(
+    `SELECT r.message_id, r.user_id, r.emoji, r.reacted_at, r.updated_at
+     FROM message_reactions r
+     JOIN messages m ON m.message_id = r.message_id
+     WHERE r.message_id = ANY($1::text[])
+     ORDER BY m.conversation_id ASC, m.seq ASC, r.reacted_at ASC`,
+    [rows.map((row) => row.message_id)],
+  );
+
+  const messages = new Array(rows.length);
+  let cursor = 0;
+  for (let index = 0; index < rows.length; index += 1) {
+    const row = rows[index];
+    const attached: any[] = [];
+    while (
+      cursor < reactions.length &&
+      reactions[cursor].message_id === row.message_id
+    ) {
+      attached.push(mapReaction(reactions[cursor]));
+      cursor += 1;
+    }
+    messages[index] = mapMessage(row, attached);
+  }
+  return messages;
+}
+
+/**
+ * One keyset page of a conversation: the newest `limit` messages with
+ * `afterSeq < seq < beforeSeq`, returned oldest first.
+ */
+export async function loadHistoryPage(
+  conversationId: string,
+  options: { afterSeq: number; beforeSeq?: number | null; limit: number },
+): Promise<any[]> {
+  const params: unknown[] = [conversationId, options.afterSeq];
+  let where = "m.conversation_id = $1 AND m.seq > $2";
+  if (options.beforeSeq != null && options.beforeSeq > 0) {
+    params.push(options.beforeSeq);
+    where += ` AND m.seq < $${params.length}`;
+  }
+  params.push(options.limit);
+
+  const rows = await queryMany(
+    `${HISTORY_SELECT}
+     WHERE ${where}
+     ORDER BY m.seq DESC
+     LIMIT $${params.length}`,
+    params,
+  );
+  return mapSortedMessages(rows.reverse());
+}
+
+/**
+ * Messages in `(afterSeq, untilSeq]` for many conversations in one pass.
+ *
+ * Each window is a range on the (conversation_id, seq) unique index, so the
+ * whole delta is one statement regardless of how many conversations a
+ * reconnecting client asks about.
+ */
+export async function loadHistoryWindows(
+  windows: HistoryWindow[],
+): Promise<Map<string, any[]>> {
+  const out = new Map<string, any[]>();
+  const open = windows.filter((window) => window.untilSeq > window.afterSeq);
+  if (open.length === 0) {
+    return out;
+  }
+
+  const params: unknown[] = [];
+  const clauses = open.map((window) => {
+    params.push(window.conversationId, window.afterSeq, window.untilSeq);
+    const base = params.length - 2;
+    return `(m.conversation_id = $${base} AND m.seq > $${base + 1} AND m.seq <= $${base + 2})`;
+  });
+
+  const rows = await queryMany(
+    `${HISTORY_SELECT}
+     WHERE ${clauses.join(" OR ")}
+     ORDER BY m.conversation_id ASC, m.seq ASC`,
+    params,
+  );
+  const messages = await mapSortedMessages(rows);
+
+  // Rows arrive grouped by conversation.
+  for (const message of messages) {
+    const list = out.get(message.conversationId);
+    if (list) {
+      list.push(message);
+    } else {
+      out.set(message.conversationId, [message]);
+    }
+  }
+  return out;
+}
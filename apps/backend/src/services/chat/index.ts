@@ -10,6 +10,12 @@ import {
 import { publishToConversation, publishToUsers } from "../realtime/hub.js";
 import { enqueueNotificationEvent } from "../notification/repository.js";
 import { canSendDirectMessage } from "../../shared/policies/index.js";
+import {
+  MAX_SYNC_CONVERSATIONS,
+  loadHistoryPage,
+  loadHistoryWindows,
+  type HistoryWindow,
+} from "./history.js";
 import {
   MESSAGE_TYPES,
   createMessage,
@@ -435,6 +441,42 @@ async function ensureOwnedMediaAsset(mediaAssetId: string, userId: string) {
   return row;
 }
 
+/**
+ * Media this user may attach to a message: their own asset, or one already
+ * sent in a conversation they are still a member of (forwarding reuses the
+ * asset instead of uploading the bytes again).
+ */
+async function ensureSendableMediaAsset(mediaAssetId: string, userId: string) {
+  if (!mediaAssetId) return null;
+  const row = await queryOne(
+    `SELECT asset_id, user_id, resource_type, bytes
+     FROM media_assets
+     WHERE asset_id = $1`,
+    [mediaAssetId],
+  );
+  if (row && row.user_id === userId) {
+    return row;
+  }
+  const seen = row
+    ? await queryOne(
+        `SELECT 1
+         FROM messages m
+         JOIN conversation_members cm
+           ON cm.conversation_id = m.conversation_id
+         WHERE m.media_asset_id = $1
+           AND m.deleted_for_all_at IS NULL
+           AND cm.user_id = $2
+           AND cm.left_at IS NULL
+         LIMIT 1`,
+        [mediaAssetId, userId],
+      )
+    : null;
+  if (!seen) {
+    throw new HttpError(404, "Media asset not found");
+  }
+  return row;
+}
+
 async function ensureGroupConversationForAdmin(
   conversationId: string,
   userId: string,
@@ -2583,28 +2625,13 @@ export default async function chatService(app: any) {
       );
 
       const limit = parseLimit(request.query?.limit, 50, 1, 100);
-      const params: unknown[] = [conversationId, preference.clearedBeforeSeq];
-      let where = "conversation_id = $1 AND seq > $2";
-      const beforeSeqRaw = request.query?.beforeSeq;
-      if (beforeSeqRaw !== undefined) {
-        const beforeSeq = Number.parseInt(String(beforeSeqRaw), 10);
-        if (!Number.isNaN(beforeSeq) && beforeSeq > 0) {
-          params.push(beforeSeq);
-          where += ` AND seq < $${params.length}`;
-        }
-      }
-      params.push(limit);
+      const beforeSeq = Number.parseInt(String(request.query?.beforeSeq), 10);
 
-      const messages = await queryMany(
-        `SELECT *
-       FROM messages
-       WHERE ${where}
-       ORDER BY seq DESC
-       LIMIT $${params.length}`,
-        params,
-      );
-
-      return await loadMessagesWithReactions(messages.reverse());
+      return loadHistoryPage(conversationId, {
+        afterSeq: preference.clearedBeforeSeq,
+        beforeSeq: Number.isNaN(beforeSeq) ? null : beforeSeq,
+        limit,
+      });
     },
   );
 
@@ -2994,8 +3021,13 @@ export default async function chatService(app: any) {
     }
 
     if (normalized.length === 0) {
-      return { conversations: [] };
+      return { conversations: [], truncated: false, remaining: [] };
     }
+    // Past the cap nothing is dropped silently: the ids that were not synced
+    // go back as `remaining` for the client's next request.
+    const remaining = normalized
+      .splice(MAX_SYNC_CONVERSATIONS)
+      .map((item) => item.conversationId);
 
     const requestedConversationIds = normalized.map(
       (item) => item.conversationId,
@@ -3017,8 +3049,24 @@ export default async function chatService(app: any) {
     const allowedMap = new Map(
       allowedConversations.map((item) => [item.conversationId, item]),
     );
+    const clearedRows = await queryMany(
+      `SELECT conversation_id, cleared_before_seq
+       FROM conversation_user_preferences
+       WHERE user_id = $1
+         AND conversation_id IN (${conversationPlaceholders})`,
+      [request.user.userId, ...requestedConversationIds],
+    );
+    const clearedMap = new Map(
+      clearedRows.map((row) => [
+        String(row.conversation_id),
+        Number(row.cleared_before_seq || 0),
+      ]),
+    );
 
-    const conversations: Array<any> = [];
+    // Each conversation's delta is the seq range after what the client has,
+    // capped at limitPerConversation; every range is then read in one query.
+    const windows: Array<HistoryWindow & { meta: any; currentSeq: number }> =
+      [];
     for (const item of normalized) {
       const meta = allowedMap.get(item.conversationId);
       if (!meta) continue;
@@ -3030,34 +3078,34 @@ export default async function chatService(app: any) {
       ) {
         continue;
       }
-      const preference = await loadPreference(
-        item.conversationId,
-        request.user.userId,
-      );
-      const lastKnownSeq = Math.max(
+      const afterSeq = Math.max(
         item.lastKnownSeq,
-        preference.clearedBeforeSeq,
-      );
-
-      const deltaMessages = await queryMany(
-        `SELECT *
-         FROM messages
-         WHERE conversation_id = $1 AND seq > $2
-         ORDER BY seq ASC
-         LIMIT $3`,
-        [item.conversationId, lastKnownSeq, limitPerConversation],
+        clearedMap.get(item.conversationId) || 0,
       );
-
-      conversations.push({
+      const currentSeq = Number(meta.seqCounter || meta.lastMessageSeq || 0);
+      windows.push({
         conversationId: item.conversationId,
-        hasMore: deltaMessages.length === limitPerConversation,
-        currentSeq: Number(meta.seqCounter || meta.lastMessageSeq || 0),
-        updatedAt: toIso(meta.updatedAt),
-        messages: await loadMessagesWithReactions(deltaMessages),
+        afterSeq,
+        untilSeq: Math.min(currentSeq, afterSeq + limitPerConversation),
+        meta,
+        currentSeq,
       });
     }
 
-    return { conversations };
+    const deltas = await loadHistoryWindows(windows);
+    const conversations = windows.map((window) => ({
+      conversationId: window.conversationId,
+      hasMore: window.currentSeq > window.untilSeq,
+      currentSeq: window.currentSeq,
+      updatedAt: toIso(window.meta.updatedAt),
+      messages: deltas.get(window.conversationId) || [],
+    }));
+
+    return {
+      conversations,
+      truncated: remaining.length > 0,
+      remaining,
+    };
   });
 
   app.post(
@@ -3114,7 +3162,7 @@ export default async function chatService(app: any) {
         ensure(mediaAssetId.length > 0, 400, "Attachment media is required");
       }
       if (mediaAssetId) {
-        await ensureOwnedMediaAsset(mediaAssetId, request.user.userId);
+        await ensureSendableMediaAsset(mediaAssetId, request.user.userId);
       }
       ensure(
         deviceId.length >= 3 && deviceId.length <= 128,
@@ -250,7 +250,7 @@ export async function ensureUserExists(userId: string): Promise<any> {
   };
 }
 
-function mapReaction(row: any) {
+export function mapReaction(row: any) {
   return {
     userId: row.user_id,
     emoji: row.emoji,
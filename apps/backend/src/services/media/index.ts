@@ -1,16 +1,35 @@
+import { Readable } from "node:stream";
+
 import { requireAuth } from "../../lib/auth.js";
 import {
   deleteMedia,
   isCloudinaryConfigured,
   uploadMedia,
+  uploadMediaStream,
+  type UploadResult,
 } from "../../lib/cloudinary.js";
 import { query, queryMany, queryOne } from "../../lib/pg.js";
 import {
   HttpError,
   ensure,
+  generateId,
   now,
   toIso,
 } from "../../lib/security.js";
+import {
+  MAX_CHUNK_BYTES,
+  MAX_UPLOAD_BYTES,
+  MIN_CHUNK_BYTES,
+  UPLOAD_TTL_MS,
+  assembledStream,
+  chunkCount,
+  chunkLength,
+  createUploadDir,
+  isDigest,
+  mediaContentHash,
+  receiveChunk,
+  removeUploadChunks,
+} from "./uploads.js";
 
 function normalizeString(value: unknown): string {
   return String(value || "").trim();
@@ -24,6 +43,19 @@ function parseLimit(raw: unknown, fallback: number, min: number, max: number): n
   return Math.max(min, Math.min(max, parsed));
 }
 
+const RESOURCE_TYPES = ["auto", "image", "video", "raw"];
+
+function normalizeUploadTarget(body: any) {
+  const resourceType = normalizeString(body.resourceType || "auto").toLowerCase();
+  ensure(RESOURCE_TYPES.includes(resourceType), 400, "Invalid resource type");
+
+  return {
+    resourceType: resourceType as "auto" | "image" | "video" | "raw",
+    context: normalizeString(body.context || "general").slice(0, 80) || "general",
+    folder: normalizeString(body.folder || "prava").slice(0, 120) || "prava",
+  };
+}
+
 function mapMediaAsset(row: any) {
   return {
     assetId: row.asset_id,
@@ -41,7 +73,149 @@ function mapMediaAsset(row: any) {
   };
 }
 
+function parseChunkHashes(value: unknown): string[] {
+  const raw = typeof value === "string" ? JSON.parse(value) : value;
+  return Array.isArray(raw) ? raw.map((hash) => normalizeString(hash).toLowerCase()) : [];
+}
+
+function mapMediaUpload(row: any, receivedChunks: number[]) {
+  const totalBytes = Number(row.total_bytes);
+  return {
+    uploadId: row.upload_id,
+    contentHash: row.content_hash,
+    totalBytes,
+    chunkSize: row.chunk_size,
+    chunkCount: chunkCount(totalBytes, row.chunk_size),
+    receivedChunks,
+    status: row.status,
+    expiresAt: toIso(row.expires_at),
+  };
+}
+
+async function loadReceivedChunks(uploadId: string): Promise<number[]> {
+  const rows = await queryMany(
+    `SELECT chunk_index
+     FROM media_upload_chunks
+     WHERE upload_id = $1
+     ORDER BY chunk_index ASC`,
+    [uploadId]
+  );
+  return rows.map((row) => Number(row.chunk_index));
+}
+
+async function loadUpload(uploadId: string, userId: string) {
+  ensure(uploadId.length >= 8, 400, "Invalid upload");
+  const row = await queryOne(
+    `SELECT *
+     FROM media_uploads
+     WHERE upload_id = $1 AND user_id = $2 AND expires_at > $3`,
+    [uploadId, userId, now()]
+  );
+  if (!row) {
+    throw new HttpError(404, "Upload not found");
+  }
+  return row;
+}
+
+async function insertMediaAsset(
+  userId: string,
+  uploaded: UploadResult,
+  target: { folder: string; context: string },
+  createdAt: Date,
+  contentHash: string | null
+) {
+  const row = await queryOne(
+    `INSERT INTO media_assets (
+       asset_id, user_id, public_id, url, secure_url, resource_type, format,
+       width, height, bytes, folder, context, created_at, content_hash
+     )
+     VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14)
+     ON CONFLICT (asset_id) DO NOTHING
+     RETURNING *`,
+    [
+      uploaded.assetId,
+      userId,
+      uploaded.publicId,
+      uploaded.url,
+      uploaded.secureUrl,
+      uploaded.resourceType,
+      uploaded.format,
+      uploaded.width,
+      uploaded.height,
+      uploaded.bytes,
+      target.folder,
+      target.context,
+      createdAt,
+      contentHash,
+    ]
+  );
+  return row ?? queryOne(`SELECT * FROM media_assets WHERE asset_id = $1`, [uploaded.assetId]);
+}
+
+/**
+ * This user's own asset with the same content. Dedup never crosses users:
+ * the chunk hashes are not proof of holding the bytes, so matching another
+ * user's asset would hand out their media (and reveal that it exists).
+ */
+async function findOwnAssetByContentHash(contentHash: string, userId: string) {
+  return queryOne(
+    `SELECT *
+     FROM media_assets
+     WHERE user_id = $1 AND content_hash = $2
+     ORDER BY created_at DESC
+     LIMIT 1`,
+    [userId, contentHash]
+  );
+}
+
+// Uploads stuck in 'assembling' this long after their last activity are
+// treated as abandoned (the instance completing them went away).
+const STALE_ASSEMBLY_MS = 60 * 60 * 1000;
+const UPLOAD_SWEEP_INTERVAL_MS = 15 * 60 * 1000;
+
+/** Drop every expired upload, for all users, along with its chunk files. */
+export async function sweepExpiredUploads(ts = now()): Promise<number> {
+  const expired = await queryMany(
+    `DELETE FROM media_uploads
+     WHERE expires_at <= $1
+       AND (status = 'pending' OR updated_at <= $2)
+     RETURNING upload_id`,
+    [ts, new Date(ts.getTime() - STALE_ASSEMBLY_MS)]
+  );
+  await Promise.all(expired.map((row) => removeUploadChunks(row.upload_id)));
+  return expired.length;
+}
+
+function startUploadSweeper(app: any) {
+  if (process.env.NODE_ENV === "test") return;
+  const timer = setInterval(() => {
+    sweepExpiredUploads()
+      .then((removed) => {
+        if (removed > 0) {
+          app.log?.info?.({ removed }, "expired media uploads removed");
+        }
+      })
+      .catch((error) => {
+        app.log?.warn?.({ err: error }, "media upload sweep failed");
+      });
+  }, UPLOAD_SWEEP_INTERVAL_MS);
+  timer.unref?.();
+
+  app.addHook?.("onClose", async () => {
+    clearInterval(timer);
+  });
+}
+
 export default async function mediaService(app: any) {
+  // Chunk bodies are streamed to disk by the route, never buffered.
+  app.addContentTypeParser(
+    "application/octet-stream",
+    (_request: any, payload: any, done: (error: Error | null, body?: unknown) => void) => {
+      done(null, payload);
+    }
+  );
+  startUploadSweeper(app);
+
   app.get("/", { preHandler: requireAuth }, async (request: any) => {
     const limit = parseLimit(request.query?.limit, 30, 1, 100);
     const rows = await queryMany(
@@ -84,16 +258,9 @@ export default async function mediaService(app: any) {
     const source = normalizeString(body.file || body.url || body.dataUri);
     ensure(source.length > 0, 400, "Missing upload source");
 
-    const resourceType = normalizeString(body.resourceType || "auto").toLowerCase();
-    ensure(["auto", "image", "video", "raw"].includes(resourceType), 400, "Invalid resource type");
-
-    const context = normalizeString(body.context || "general").slice(0, 80) || "general";
-    const folder = normalizeString(body.folder || "prava").slice(0, 120) || "prava";
+    const { resourceType, context, folder } = normalizeUploadTarget(body);
 
-    const uploaded = await uploadMedia(source, {
-      folder,
-      resourceType: resourceType as "auto" | "image" | "video" | "raw",
-    });
+    const uploaded = await uploadMedia(source, { folder, resourceType });
     const createdAt = now();
 
     await query(
@@ -130,6 +297,211 @@ export default async function mediaService(app: any) {
     };
   });
 
+  // Resumable, content-addressed uploads. The client hashes the file into
+  // fixed-size chunks first; media this user already uploaded resolves to
+  // their asset immediately, otherwise missing chunks are PUT in any order
+  // and concurrently, then assembled on complete. Forwards never get here:
+  // they send the source message's asset id (ensureSendableMediaAsset).
+  app.post("/uploads", { preHandler: requireAuth }, async (request: any) => {
+    const body = request.body || {};
+    const userId = request.user.userId;
+    const totalBytes = Number(body.totalBytes);
+    const chunkSize = Number(body.chunkSize);
+    const contentHash = normalizeString(body.contentHash).toLowerCase();
+    const chunkHashes = parseChunkHashes(body.chunkHashes);
+
+    ensure(Number.isSafeInteger(totalBytes) && totalBytes > 0, 400, "Invalid upload size");
+    ensure(totalBytes <= MAX_UPLOAD_BYTES, 413, "Upload is too large");
+    ensure(
+      Number.isInteger(chunkSize) && chunkSize >= MIN_CHUNK_BYTES && chunkSize <= MAX_CHUNK_BYTES,
+      400,
+      "Invalid chunk size"
+    );
+    ensure(isDigest(contentHash), 400, "Invalid content hash");
+    ensure(
+      chunkHashes.length === chunkCount(totalBytes, chunkSize) && chunkHashes.every(isDigest),
+      400,
+      "Invalid chunk hashes"
+    );
+    ensure(
+      mediaContentHash(totalBytes, chunkSize, chunkHashes) === contentHash,
+      400,
+      "Content hash does not match chunk hashes"
+    );
+
+    const target = normalizeUploadTarget(body);
+    const ts = now();
+
+    const reused = await findOwnAssetByContentHash(contentHash, userId);
+    if (reused) {
+      return { deduplicated: true, asset: mapMediaAsset(reused) };
+    }
+
+    const pending = await queryOne(
+      `SELECT *
+       FROM media_uploads
+       WHERE user_id = $1 AND content_hash = $2 AND status = 'pending'
+         AND expires_at > $3
+       ORDER BY created_at DESC
+       LIMIT 1`,
+      [userId, contentHash, ts]
+    );
+    if (pending) {
+      return {
+        deduplicated: false,
+        upload: mapMediaUpload(pending, await loadReceivedChunks(pending.upload_id)),
+      };
+    }
+
+    if (!isCloudinaryConfigured()) {
+      throw new HttpError(503, "Media uploads are not configured");
+    }
+
+    const row = await queryOne(
+      `INSERT INTO media_uploads (
+         upload_id, user_id, content_hash, total_bytes, chunk_size, chunk_hashes,
+         resource_type, folder, context, status, created_at, updated_at, expires_at
+       )
+       VALUES ($1, $2, $3, $4, $5, $6::jsonb, $7, $8, $9, 'pending', $10, $10, $11)
+       RETURNING *`,
+      [
+        generateId(),
+        userId,
+        contentHash,
+        totalBytes,
+        chunkSize,
+        JSON.stringify(chunkHashes),
+        target.resourceType,
+        target.folder,
+        target.context,
+        ts,
+        new Date(ts.getTime() + UPLOAD_TTL_MS),
+      ]
+    );
+    await createUploadDir(row.upload_id);
+
+    return { deduplicated: false, upload: mapMediaUpload(row, []) };
+  });
+
+  app.get("/uploads/:uploadId", { preHandler: requireAuth }, async (request: any) => {
+    const upload = await loadUpload(normalizeString(request.params.uploadId), request.user.userId);
+    return { upload: mapMediaUpload(upload, await loadReceivedChunks(upload.upload_id)) };
+  });
+
+  app.put(
+    "/uploads/:uploadId/chunks/:index",
+    { preHandler: requireAuth },
+    async (request: any) => {
+      const upload = await loadUpload(normalizeString(request.params.uploadId), request.user.userId);
+      ensure(upload.status === "pending", 409, "Upload is already completing");
+      ensure(request.body instanceof Readable, 415, "Chunks must be application/octet-stream");
+
+      const totalBytes = Number(upload.total_bytes);
+      const index = Number.parseInt(String(request.params.index), 10);
+      ensure(
+        Number.isInteger(index) && index >= 0 && index < chunkCount(totalBytes, upload.chunk_size),
+        400,
+        "Invalid chunk index"
+      );
+
+      await receiveChunk(
+        upload.upload_id,
+        index,
+        request.body,
+        chunkLength(totalBytes, upload.chunk_size, index),
+        parseChunkHashes(upload.chunk_hashes)[index]
+      );
+      // The upload may have been completed, cancelled or swept while the
+      // chunk streamed in; a chunk that arrives after that is not kept.
+      const ts = now();
+      const current = await queryOne(
+        `UPDATE media_uploads SET updated_at = $2
+         WHERE upload_id = $1
+         RETURNING status`,
+        [upload.upload_id, ts]
+      );
+      if (!current) {
+        await removeUploadChunks(upload.upload_id);
+        throw new HttpError(404, "Upload not found");
+      }
+      ensure(current.status === "pending", 409, "Upload is already completing");
+      await query(
+        `INSERT INTO media_upload_chunks (upload_id, chunk_index, bytes, received_at)
+         VALUES ($1, $2, $3, $4)
+         ON CONFLICT (upload_id, chunk_index) DO NOTHING`,
+        [upload.upload_id, index, chunkLength(totalBytes, upload.chunk_size, index), ts]
+      );
+
+      return { uploadId: upload.upload_id, index, received: true };
+    }
+  );
+
+  app.post(
+    "/uploads/:uploadId/complete",
+    { preHandler: requireAuth },
+    async (request: any) => {
+      const userId = request.user.userId;
+      const upload = await loadUpload(normalizeString(request.params.uploadId), userId);
+      const uploadId = upload.upload_id;
+      const claimed = await queryOne(
+        `UPDATE media_uploads
+         SET status = 'assembling', updated_at = $3
+         WHERE upload_id = $1 AND user_id = $2 AND status = 'pending'
+         RETURNING upload_id`,
+        [uploadId, userId, now()]
+      );
+      ensure(claimed, 409, "Upload is already completing");
+
+      const totalBytes = Number(upload.total_bytes);
+      const count = chunkCount(totalBytes, upload.chunk_size);
+      const target = {
+        resourceType: upload.resource_type,
+        folder: upload.folder,
+        context: upload.context,
+      };
+
+      try {
+        const received = await loadReceivedChunks(uploadId);
+        ensure(received.length === count, 409, "Upload is missing chunks");
+
+        // Another upload of the same content by this user may have finished
+        // while this one ran.
+        const ts = now();
+        let deduplicated = true;
+        let row = await findOwnAssetByContentHash(upload.content_hash, userId);
+        if (!row) {
+          if (!isCloudinaryConfigured()) {
+            throw new HttpError(503, "Media uploads are not configured");
+          }
+          const uploaded = await uploadMediaStream(assembledStream(uploadId, count), {
+            folder: target.folder,
+            resourceType: target.resourceType,
+          });
+          row = await insertMediaAsset(userId, uploaded, target, ts, upload.content_hash);
+          deduplicated = false;
+        }
+
+        await query(`DELETE FROM media_uploads WHERE upload_id = $1`, [uploadId]);
+        await removeUploadChunks(uploadId);
+        return { deduplicated, asset: mapMediaAsset(row) };
+      } catch (error) {
+        await query(
+          `UPDATE media_uploads SET status = 'pending', updated_at = $2 WHERE upload_id = $1`,
+          [uploadId, now()]
+        );
+        throw error;
+      }
+    }
+  );
+
+  app.delete("/uploads/:uploadId", { preHandler: requireAuth }, async (request: any) => {
+    const upload = await loadUpload(normalizeString(request.params.uploadId), request.user.userId);
+    ensure(upload.status === "pending", 409, "Upload is already completing");
+    await query(`DELETE FROM media_uploads WHERE upload_id = $1`, [upload.upload_id]);
+    await removeUploadChunks(upload.upload_id);
+    return { deleted: true };
+  });
+
   app.delete("/:assetId", { preHandler: requireAuth }, async (request: any) => {
     const assetId = normalizeString(request.params.assetId);
     ensure(assetId.length >= 3, 400, "Invalid asset");
@@ -144,7 +516,17 @@ export default async function mediaService(app: any) {
       throw new HttpError(404, "Media asset not found");
     }
 
-    await deleteMedia(row.public_id, row.resource_type || "image");
+    // Never delete a Cloudinary resource another asset row still points at.
+    const shared = await queryOne(
+      `SELECT 1
+       FROM media_assets
+       WHERE public_id = $1 AND asset_id <> $2
+       LIMIT 1`,
+      [row.public_id, assetId]
+    );
+    if (!shared) {
+      await deleteMedia(row.public_id, row.resource_type || "image");
+    }
     const result = await query(
       `DELETE FROM media_assets WHERE asset_id = $1 AND user_id = $2`,
       [assetId, request.user.userId]
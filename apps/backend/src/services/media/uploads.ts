@@ -0,0 +1,142 @@
+import { createHash } from "node:crypto";
+import { createReadStream, createWriteStream } from "node:fs";
+import { mkdir, rename, rm } from "node:fs/promises";
+import os from "node:os";
+import path from "node:path";
+import { Readable } from "node:stream";
+import { pipeline } from "node:stream/promises";
+
+import { env } from "../../config/env.js";
+import { HttpError } from "../../lib/security.js";
+
+// Content addressing shared with the mobile client
+// (linux/native/media/media_manifest.cc): every chunk is hashed with
+// BLAKE2b-512 truncated to 32 bytes, and the content hash is the same digest
+// over the domain tag, the file size, the chunk size and the chunk digests.
+const ROOT_TAG = "prava-media-v1";
+const DIGEST_BYTES = 32;
+
+export const MIN_CHUNK_BYTES = 256 * 1024;
+export const MAX_CHUNK_BYTES = 8 * 1024 * 1024;
+export const MAX_UPLOAD_BYTES = 512 * 1024 * 1024;
+export const UPLOAD_TTL_MS = 24 * 60 * 60 * 1000;
+
+const DIGEST_PATTERN = /^[0-9a-f]{64}$/;
+
+function digest(parts: Buffer[]): string {
+  const hash = createHash("blake2b512");
+  for (const part of parts) {
+    hash.update(part);
+  }
+  return hash.digest().subarray(0, DIGEST_BYTES).toString("hex");
+}
+
+export function isDigest(value: unknown): value is string {
+  return typeof value === "string" && DIGEST_PATTERN.test(value);
+}
+
+export function chunkCount(totalBytes: number, chunkSize: number): number {
+  return Math.ceil(totalBytes / chunkSize);
+}
+
+export function chunkLength(totalBytes: number, chunkSize: number, index: number): number {
+  return Math.min(chunkSize, totalBytes - index * chunkSize);
+}
+
+export function mediaContentHash(
+  totalBytes: number,
+  chunkSize: number,
+  chunkHashes: string[]
+): string {
+  const header = Buffer.alloc(12);
+  header.writeBigUInt64LE(BigInt(totalBytes), 0);
+  header.writeUInt32LE(chunkSize, 8);
+  return digest([
+    Buffer.from(ROOT_TAG, "ascii"),
+    header,
+    ...chunkHashes.map((hash) => Buffer.from(hash, "hex")),
+  ]);
+}
+
+// Chunks live on local disk until the upload completes, so chunk requests
+// for one upload must reach the same instance (or MEDIA_UPLOAD_DIR must be a
+// shared volume).
+function uploadDir(uploadId: string): string {
+  const root = env.MEDIA_UPLOAD_DIR || path.join(os.tmpdir(), "prava-media-uploads");
+  return path.join(root, uploadId);
+}
+
+function chunkPath(uploadId: string, index: number): string {
+  return path.join(uploadDir(uploadId), String(index));
+}
+
+/** Chunk directory for a new upload; chunks are only accepted while it exists. */
+export async function createUploadDir(uploadId: string): Promise<void> {
+  await mkdir(uploadDir(uploadId), { recursive: true });
+}
+
+/**
+ * Stream one chunk to disk, hashing it on the way. The chunk only becomes
+ * visible under its final name once its length and digest match the
+ * manifest, so a retried or interrupted PUT never leaves a bad chunk behind.
+ * The upload directory is never recreated here: once the upload has been
+ * completed or removed, a late chunk fails with 404 instead of leaving files
+ * behind.
+ */
+export async function receiveChunk(
+  uploadId: string,
+  index: number,
+  source: Readable,
+  expectedBytes: number,
+  expectedHash: string
+): Promise<void> {
+  const finalPath = chunkPath(uploadId, index);
+  const partPath = `${finalPath}.${process.pid}.${Date.now()}.part`;
+  const hash = createHash("blake2b512");
+  let received = 0;
+
+  try {
+    await pipeline(
+      source,
+      async function* (chunks: AsyncIterable<Buffer>) {
+        for await (const chunk of chunks) {
+          received += chunk.length;
+          if (received > expectedBytes) {
+            throw new HttpError(413, "Chunk is larger than declared");
+          }
+          hash.update(chunk);
+          yield chunk;
+        }
+      },
+      createWriteStream(partPath)
+    );
+
+    if (received !== expectedBytes) {
+      throw new HttpError(400, "Chunk is shorter than declared");
+    }
+    if (hash.digest().subarray(0, DIGEST_BYTES).toString("hex") !== expectedHash) {
+      throw new HttpError(422, "Chunk hash mismatch");
+    }
+    await rename(partPath, finalPath);
+  } catch (error: any) {
+    await rm(partPath, { force: true });
+    if (error?.code === "ENOENT") {
+      throw new HttpError(404, "Upload not found");
+    }
+    throw error;
+  }
+}
+
+/** The uploaded chunks, in order, as one stream read from disk. */
+export function assembledStream(uploadId: string, count: number): Readable {
+  async function* chunks() {
+    for (let index = 0; index < count; index += 1) {
+      yield* createReadStream(chunkPath(uploadId, index));
+    }
+  }
+  return Readable.from(chunks());
+}
+
+export async function removeUploadChunks(uploadId: string): Promise<void> {
+  await rm(uploadDir(uploadId), { recursive: true, force: true });
+}
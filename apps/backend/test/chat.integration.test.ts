@@ -611,6 +611,136 @@ test("chat routes: dm create, send message, read + delivery + sync", async () =>
   assert.equal(unblockA.data.blocked, false);
 });
 
+test("chat sync: windows per conversation, clear point and over-cap remainder", async () => {
+  const createGroup = async (title: string) => {
+    const created = await httpJson<{ conversationId: string }>(
+      baseUrl,
+      "/api/conversations/group",
+      {
+        method: "POST",
+        token: userAToken,
+        body: { title, memberIds: [userBId] },
+      }
+    );
+    assert.equal(created.status, 200, JSON.stringify(created.data));
+    return created.data.conversationId;
+  };
+  const send = async (conversationId: string, body: string) => {
+    const sent = await httpJson<{ message: { seq: number } }>(
+      baseUrl,
+      `/api/conversations/${conversationId}/messages`,
+      {
+        method: "POST",
+        token: userAToken,
+        body: { body, contentType: "text", deviceId: "device-a" },
+      }
+    );
+    assert.equal(sent.status, 200, JSON.stringify(sent.data));
+    return sent.data.message.seq;
+  };
+  type SyncResponse = {
+    conversations: Array<{
+      conversationId: string;
+      hasMore: boolean;
+      currentSeq: number;
+      messages: Array<{ seq: number; body: string }>;
+    }>;
+    truncated: boolean;
+    remaining: string[];
+  };
+
+  const longId = await createGroup("Sync window group");
+  await send(longId, "window one");
+  await send(longId, "window two");
+  const longLastSeq = await send(longId, "window three");
+
+  const clearedId = await createGroup("Sync clear group");
+  await send(clearedId, "before clear one");
+  const clearPoint = await send(clearedId, "before clear two");
+  const clear = await httpJson<{ clearedBeforeSeq: number }>(
+    baseUrl,
+    `/api/conversations/${clearedId}/clear-local`,
+    { method: "POST", token: userAToken, body: {} }
+  );
+  assert.equal(clear.status, 200, JSON.stringify(clear.data));
+  assert.equal(clear.data.clearedBeforeSeq, clearPoint);
+  const afterClearSeq = await send(clearedId, "after clear");
+
+  const sync = await httpJson<SyncResponse>(
+    baseUrl,
+    "/api/conversations/sync",
+    {
+      method: "POST",
+      token: userAToken,
+      body: {
+        conversations: [
+          { conversationId: longId, lastKnownSeq: longLastSeq - 3 },
+          { conversationId: clearedId, lastKnownSeq: 0 },
+        ],
+        limitPerConversation: 2,
+      },
+    }
+  );
+  assert.equal(sync.status, 200, JSON.stringify(sync.data));
+  assert.equal(sync.data.truncated, false);
+  assert.deepEqual(sync.data.remaining, []);
+  assert.equal(sync.data.conversations.length, 2);
+
+  // The window stops two messages in; the third is still ahead of it.
+  const longDelta = sync.data.conversations.find(
+    (item) => item.conversationId === longId
+  );
+  assert.ok(longDelta);
+  assert.equal(longDelta.currentSeq, longLastSeq);
+  assert.equal(longDelta.hasMore, true);
+  assert.deepEqual(
+    longDelta.messages.map((message) => message.body),
+    ["window one", "window two"]
+  );
+
+  // lastKnownSeq 0 is raised to the clear point, so only the newer message
+  // comes back.
+  const clearedDelta = sync.data.conversations.find(
+    (item) => item.conversationId === clearedId
+  );
+  assert.ok(clearedDelta);
+  assert.equal(clearedDelta.currentSeq, afterClearSeq);
+  assert.equal(clearedDelta.hasMore, false);
+  assert.deepEqual(
+    clearedDelta.messages.map((message) => message.seq),
+    [afterClearSeq]
+  );
+
+  const padding = Array.from({ length: 199 }, (_, index) => ({
+    conversationId: `missing_conversation_${index}`,
+    lastKnownSeq: 0,
+  }));
+  const overCap = await httpJson<SyncResponse>(
+    baseUrl,
+    "/api/conversations/sync",
+    {
+      method: "POST",
+      token: userAToken,
+      body: {
+        conversations: [
+          { conversationId: longId, lastKnownSeq: longLastSeq },
+          ...padding,
+          { conversationId: clearedId, lastKnownSeq: clearPoint },
+        ],
+      },
+    }
+  );
+  assert.equal(overCap.status, 200, JSON.stringify(overCap.data));
+  assert.equal(overCap.data.truncated, true);
+  assert.deepEqual(overCap.data.remaining, [clearedId]);
+  assert.deepEqual(
+    overCap.data.conversations.map((item) => item.conversationId),
+    [longId]
+  );
+  assert.equal(overCap.data.conversations[0].messages.length, 0);
+  assert.equal(overCap.data.conversations[0].hasMore, false);
+});
+
 test("settings routes expose grouped settings, mobile legacy bridge, search, and audit", async () => {
   const initial = await httpJson<{
     legacy: { activityStatus: boolean; themeIndex: number };
@@ -1013,6 +1143,84 @@ test("chat groups: invite approvals, role updates, and attachment lifecycle", as
   assert.equal(attachments.data.items[0]?.status, "attached");
 });
 
+test("chat media: forwarding reuses an asset only from a conversation the sender is in", async () => {
+  const groupCreate = await httpJson<{ conversationId: string }>(
+    baseUrl,
+    "/api/conversations/group",
+    {
+      method: "POST",
+      token: userAToken,
+      body: { title: "Forward source group", memberIds: [userBId] },
+    }
+  );
+  assert.equal(groupCreate.status, 200, JSON.stringify(groupCreate.data));
+  const groupId = groupCreate.data.conversationId;
+
+  const pgLib = await import("../src/lib/pg.js");
+  const mediaAssetId = `asset_${Date.now()}_forward`;
+  await pgLib.query(
+    `INSERT INTO media_assets (
+       asset_id, user_id, public_id, url, secure_url, resource_type,
+       format, width, height, bytes, folder, context, created_at
+     )
+     VALUES ($1, $2, $3, $4, $5, 'video', 'mp4', 640, 360, 4096, 'chat', 'chat_attachment', NOW())`,
+    [
+      mediaAssetId,
+      userAId,
+      `public_${mediaAssetId}`,
+      `https://cdn.example.com/${mediaAssetId}.mp4`,
+      `https://cdn.example.com/${mediaAssetId}.mp4`,
+    ]
+  );
+
+  const sendMedia = (conversationId: string, token: string, clientMessageId: string) =>
+    httpJson<{ message: { mediaAssetId: string } }>(
+      baseUrl,
+      `/api/conversations/${conversationId}/messages`,
+      {
+        method: "POST",
+        token,
+        body: {
+          body: "",
+          contentType: "video",
+          deviceId: "device-forward",
+          mediaAssetId,
+          clientMessageId,
+        },
+      }
+    );
+
+  const original = await sendMedia(groupId, userAToken, "00000000-0000-4000-8000-000000000301");
+  assert.equal(original.status, 200, JSON.stringify(original.data));
+
+  const cToA = await httpJson<{ conversationId: string }>(baseUrl, "/api/conversations/dm", {
+    method: "POST",
+    token: userCToken,
+    body: { otherUserId: userAId },
+  });
+  assert.equal(cToA.status, 200, JSON.stringify(cToA.data));
+
+  // C has never been shown the asset, so it cannot send it by id.
+  const unseen = await sendMedia(cToA.data.conversationId, userCToken, "00000000-0000-4000-8000-000000000302");
+  assert.equal(unseen.status, 404, JSON.stringify(unseen.data));
+
+  const bToC = await httpJson<{ conversationId: string }>(baseUrl, "/api/conversations/dm", {
+    method: "POST",
+    token: userBToken,
+    body: { otherUserId: userCId },
+  });
+  assert.equal(bToC.status, 200, JSON.stringify(bToC.data));
+
+  // B saw it in the group: the forward reuses A's asset without an upload.
+  const forwarded = await sendMedia(bToC.data.conversationId, userBToken, "00000000-0000-4000-8000-000000000303");
+  assert.equal(forwarded.status, 200, JSON.stringify(forwarded.data));
+  assert.equal(forwarded.data.message.mediaAssetId, mediaAssetId);
+
+  // Now C has been sent it too.
+  const reforwarded = await sendMedia(cToA.data.conversationId, userCToken, "00000000-0000-4000-8000-000000000304");
+  assert.equal(reforwarded.status, 200, JSON.stringify(reforwarded.data));
+});
+
 test("realtime plugin does not handle plain root requests", async () => {
   const response = await fetch(baseUrl, { method: "HEAD" });
   assert.notEqual(response.status, 500);
@@ -0,0 +1,96 @@
+import assert from "node:assert/strict";
+import { mkdtemp, readFile, readdir, rm } from "node:fs/promises";
+import os from "node:os";
+import path from "node:path";
+import { Readable } from "node:stream";
+import test, { after, before } from "node:test";
+
+let uploads: typeof import("../src/services/media/uploads.js");
+let uploadRoot = "";
+
+// Pattern bytes (i % 251); the digests were computed independently with
+// Python's hashlib.blake2b(digest_size=64), truncated to 32 bytes.
+const CHUNK_SIZE = 256 * 1024;
+const content = Buffer.from(Array.from({ length: 600_000 }, (_, i) => i % 251));
+const chunkHashes = [
+  "6c1cc17637ca0cfa8dac743111b5a3efed0fae7b7d4bcc3b73946e392d666549",
+  "ff37b8577d88f6052f622e3dba223ea405bee371a17ffe629aee82f7e1dea84c",
+  "beb9a2115519695ed9a1343fc90b428801d961992a7229fd62d60e72ec3f1451",
+];
+const contentHash = "06e376b7b43955e3d20bc6865b0f440e03551a58afa1e1b6b1e18f8b888f2f60";
+
+function chunkOf(index: number): Buffer {
+  return content.subarray(index * CHUNK_SIZE, (index + 1) * CHUNK_SIZE);
+}
+
+before(async () => {
+  process.env.NODE_ENV = "test";
+  process.env.JWT_SECRET = process.env.JWT_SECRET || "test_jwt_secret_key";
+  uploadRoot = await mkdtemp(path.join(os.tmpdir(), "prava-media-test-"));
+  process.env.MEDIA_UPLOAD_DIR = uploadRoot;
+  uploads = await import("../src/services/media/uploads.js");
+});
+
+after(async () => {
+  await rm(uploadRoot, { recursive: true, force: true });
+});
+
+test("content hash matches the client manifest", () => {
+  assert.equal(uploads.chunkCount(content.length, CHUNK_SIZE), 3);
+  assert.equal(uploads.chunkLength(content.length, CHUNK_SIZE, 2), 600_000 - 2 * CHUNK_SIZE);
+  assert.equal(uploads.mediaContentHash(content.length, CHUNK_SIZE, chunkHashes), contentHash);
+  assert.notEqual(
+    uploads.mediaContentHash(content.length, CHUNK_SIZE, [...chunkHashes].reverse()),
+    contentHash
+  );
+});
+
+test("chunks are verified before they are kept and assemble in order", async () => {
+  const uploadId = "upload_test_chunks";
+  await uploads.createUploadDir(uploadId);
+
+  await assert.rejects(
+    uploads.receiveChunk(uploadId, 0, Readable.from([chunkOf(1)]), CHUNK_SIZE, chunkHashes[0]),
+    { statusCode: 422 }
+  );
+  await assert.rejects(
+    uploads.receiveChunk(uploadId, 0, Readable.from([chunkOf(0), Buffer.alloc(1)]), CHUNK_SIZE, chunkHashes[0]),
+    { statusCode: 413 }
+  );
+  assert.deepEqual(await readdir(path.join(uploadRoot, uploadId)), []);
+
+  // Out of order, split across several stream chunks.
+  for (const index of [2, 0, 1]) {
+    const bytes = chunkOf(index);
+    const parts = [bytes.subarray(0, 1000), bytes.subarray(1000)];
+    await uploads.receiveChunk(
+      uploadId,
+      index,
+      Readable.from(parts),
+      uploads.chunkLength(content.length, CHUNK_SIZE, index),
+      chunkHashes[index]
+    );
+  }
+
+  const assembled: Buffer[] = [];
+  for await (const part of uploads.assembledStream(uploadId, 3)) {
+    assembled.push(part as Buffer);
+  }
+  assert.ok(Buffer.concat(assembled).equals(content));
+  assert.ok((await readFile(path.join(uploadRoot, uploadId, "1"))).equals(chunkOf(1)));
+
+  await uploads.removeUploadChunks(uploadId);
+  await assert.rejects(readdir(path.join(uploadRoot, uploadId)));
+});
+
+test("chunks arriving after the upload is removed are not kept", async () => {
+  const uploadId = "upload_test_late";
+  await uploads.createUploadDir(uploadId);
+  await uploads.removeUploadChunks(uploadId);
+
+  await assert.rejects(
+    uploads.receiveChunk(uploadId, 0, Readable.from([chunkOf(0)]), CHUNK_SIZE, chunkHashes[0]),
+    { statusCode: 404 }
+  );
+  await assert.rejects(readdir(path.join(uploadRoot, uploadId)));
+});
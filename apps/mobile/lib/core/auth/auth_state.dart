@@ -2,6 +2,7 @@ import 'dart:async';
 
 import 'package:flutter/foundation.dart';
 
+import '../storage/feed_cache.dart';
 import '../storage/secure_store.dart';
 
 /// Global authentication state for the app.
@@ -52,6 +53,9 @@ class AuthState extends ChangeNotifier {
     try {
       await _store.clearSession();
     } catch (_) {}
+    try {
+      await FeedCache.instance.clear();
+    } catch (_) {}
     notifyListeners();
   }
 }
@@ -52,6 +52,15 @@ class ApiClient {
     return _requestWithRetry('POST', path, body: body, auth: auth);
   }
 
+  /// POST a body that is already JSON-encoded (e.g. by a native kernel).
+  Future<dynamic> postEncoded(
+    String path, {
+    required String body,
+    bool auth = false,
+  }) async {
+    return _requestWithRetry('POST', path, encodedBody: body, auth: auth);
+  }
+
   Future<dynamic> put(
     String path, {
     Map<String, dynamic>? body,
@@ -60,6 +69,15 @@ class ApiClient {
     return _requestWithRetry('PUT', path, body: body, auth: auth);
   }
 
+  /// PUT raw bytes as application/octet-stream (e.g. a media chunk).
+  Future<dynamic> putBytes(
+    String path, {
+    required List<int> bytes,
+    bool auth = false,
+  }) async {
+    return _requestWithRetry('PUT', path, rawBody: bytes, auth: auth);
+  }
+
   Future<dynamic> patch(
     String path, {
     Map<String, dynamic>? body,
@@ -104,31 +122,29 @@ class ApiClient {
     String method,
     String path, {
     Map<String, dynamic>? body,
+    String? encodedBody,
+    List<int>? rawBody,
     bool auth = false,
   }) async {
     final headers = await _headers(auth: auth);
     final uri = _buildUri(path);
-    final encodedBody = body == null ? null : jsonEncode(body);
-    if (encodedBody == null) {
-      headers.remove('Content-Type');
-    }
+    encodedBody ??= body == null ? null : jsonEncode(body);
+    final Object? payload = rawBody ?? encodedBody;
+    _setContentType(headers, rawBody: rawBody, encodedBody: encodedBody);
 
-    final response = await _send(method, uri, headers, encodedBody);
+    final response = await _send(method, uri, headers, payload);
 
     // If unauthorized on an authenticated request, try refreshing
     if (response.statusCode == 401 && auth) {
       final refreshed = await _tryRefresh();
       if (refreshed) {
         final retryHeaders = await _headers(auth: true);
-        if (encodedBody == null) {
-          retryHeaders.remove('Content-Type');
-        }
-        final retryResponse = await _send(
-          method,
-          uri,
+        _setContentType(
           retryHeaders,
-          encodedBody,
+          rawBody: rawBody,
+          encodedBody: encodedBody,
         );
+        final retryResponse = await _send(method, uri, retryHeaders, payload);
         return _decodeResponse(retryResponse);
       }
       await _handleForceLogout();
@@ -137,11 +153,23 @@ class ApiClient {
     return _decodeResponse(response);
   }
 
+  void _setContentType(
+    Map<String, String> headers, {
+    List<int>? rawBody,
+    String? encodedBody,
+  }) {
+    if (rawBody != null) {
+      headers['Content-Type'] = 'application/octet-stream';
+    } else if (encodedBody == null) {
+      headers.remove('Content-Type');
+    }
+  }
+
   Future<http.Response> _send(
     String method,
     Uri uri,
     Map<String, String> headers,
-    String? body,
+    Object? body,
   ) async {
     switch (method) {
       case 'POST':
@@ -0,0 +1,294 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:path_provider/path_provider.dart';
+
+/// Offline cache of the last ranked feed pages and their thumbnails.
+///
+/// Backed by linux/native/feed/feed_cache.cc: a versioned, memory-mapped
+/// file with LRU eviction under a size budget. Reads return views straight
+/// into the mapping (no copy), so the feed can render cached posts on the
+/// first frame while the network refresh runs. The runner starts readahead
+/// of the same file before the engine boots.
+///
+/// Only available where libprava_feed is bundled (Linux); elsewhere every
+/// read misses and writes are dropped.
+class FeedCache {
+  FeedCache._();
+
+  static final FeedCache instance = FeedCache._();
+
+  /// Must match the name the Linux runner prefetches.
+  static const String fileName = 'feed_cache.bin';
+
+  static const int _budgetBytes = 16 * 1024 * 1024;
+  static const int _maxPages = 12;
+  static const int _kindPage = 1;
+  static const int _kindThumbnail = 2;
+
+  _FeedCacheBindings? _bindings;
+  Pointer<Void> _handle = nullptr;
+  Future<bool>? _opening;
+
+  // Current snapshot and a view over its whole mapping. The view owns the
+  // snapshot reference (released by a NativeFinalizer), so sub-views handed
+  // out by [page] and [thumbnail] stay valid after later commits.
+  Pointer<Void> _snapshot = nullptr;
+  Uint8List? _mapping;
+  bool _stale = true;
+
+  bool get isOpen => _handle != nullptr;
+
+  /// Open the cache file; safe to call repeatedly and concurrently.
+  Future<bool> open() => _opening ??= _open();
+
+  Future<bool> _open() async {
+    final bindings = _FeedCacheBindings.load();
+    if (bindings == null) return false;
+
+    try {
+      final directory = await getApplicationSupportDirectory();
+      await directory.create(recursive: true);
+      final path = '${directory.path}/$fileName'.toNativeUtf8(
+        allocator: calloc,
+      );
+      try {
+        _handle = bindings.open(path, _budgetBytes, _maxPages);
+      } finally {
+        calloc.free(path);
+      }
+    } catch (_) {
+      return false;
+    }
+    _bindings = bindings;
+    return isOpen;
+  }
+
+  /// Cached JSON page for [key], as a view into the mapped file.
+  Uint8List? page(String key) => _read(_kindPage, key);
+
+  /// Cached image bytes for [url], as a view into the mapped file.
+  Uint8List? thumbnail(String url) => _read(_kindThumbnail, url);
+
+  /// Stage a page; written by the next [commit].
+  bool putPage(String key, List<int> bytes) => _put(_kindPage, key, bytes);
+
+  /// Stage a thumbnail; written by the next [commit].
+  bool putThumbnail(String url, List<int> bytes) =>
+      _put(_kindThumbnail, url, bytes);
+
+  /// Write staged entries as a new generation, off the UI isolate.
+  Future<bool> commit() async {
+    if (!isOpen) return false;
+    final address = _handle.address;
+    final ok = await Isolate.run(() {
+      final bindings = _FeedCacheBindings.load();
+      if (bindings == null) return false;
+      return bindings.commit(Pointer<Void>.fromAddress(address)) != 0;
+    });
+    if (ok) _stale = true;
+    return ok;
+  }
+
+  /// Drop every cached page and thumbnail (e.g. on logout).
+  Future<void> clear() async {
+    if (!await open()) return;
+    _bindings!.clear(_handle);
+    _stale = true;
+  }
+
+  Uint8List? _read(int kind, String key) {
+    final bindings = _bindings;
+    if (bindings == null || !isOpen) return null;
+    if (_stale) _remap(bindings);
+    final mapping = _mapping;
+    if (mapping == null) return null;
+
+    final keyBytes = utf8.encode(key);
+    final nativeKey = calloc<Uint8>(keyBytes.length);
+    final offset = calloc<Uint64>();
+    final length = calloc<Uint32>();
+    try {
+      nativeKey.asTypedList(keyBytes.length).setAll(0, keyBytes);
+      final found = bindings.find(
+        _snapshot,
+        kind,
+        nativeKey,
+        keyBytes.length,
+        offset,
+        length,
+      );
+      if (found == 0) return null;
+      bindings.touch(_handle, kind, nativeKey, keyBytes.length);
+      return Uint8List.sublistView(
+        mapping,
+        offset.value,
+        offset.value + length.value,
+      );
+    } finally {
+      calloc.free(nativeKey);
+      calloc.free(offset);
+      calloc.free(length);
+    }
+  }
+
+  void _remap(_FeedCacheBindings bindings) {
+    _stale = false;
+    _mapping = null;
+    _snapshot = bindings.snapshot(_handle);
+    if (_snapshot == nullptr) return;
+
+    final size = calloc<Uint64>();
+    try {
+      final data = bindings.data(_snapshot, size);
+      _mapping = data.asTypedList(
+        size.value,
+        finalizer: bindings.releaseSnapshot,
+        token: _snapshot,
+      );
+    } finally {
+      calloc.free(size);
+    }
+  }
+
+  bool _put(int kind, String key, List<int> bytes) {
+    final bindings = _bindings;
+    if (bindings == null || !isOpen) return false;
+
+    final keyBytes = utf8.encode(key);
+    final nativeKey = calloc<Uint8>(keyBytes.length);
+    final value = calloc<Uint8>(bytes.isEmpty ? 1 : bytes.length);
+    try {
+      nativeKey.asTypedList(keyBytes.length).setAll(0, keyBytes);
+      value.asTypedList(bytes.length).setAll(0, bytes);
+      return bindings.put(
+            _handle,
+            kind,
+            nativeKey,
+            keyBytes.length,
+            value,
+            bytes.length,
+          ) !=
+          0;
+    } finally {
+      calloc.free(nativeKey);
+      calloc.free(value);
+    }
+  }
+}
+
+final class _FeedCacheBindings {
+  _FeedCacheBindings(DynamicLibrary library)
+    : open = library
+          .lookupFunction<
+            Pointer<Void> Function(Pointer<Utf8>, Uint64, Uint32),
+            Pointer<Void> Function(Pointer<Utf8>, int, int)
+          >('prava_feed_cache_open'),
+      snapshot = library
+          .lookupFunction<
+            Pointer<Void> Function(Pointer<Void>),
+            Pointer<Void> Function(Pointer<Void>)
+          >('prava_feed_cache_snapshot'),
+      put = library
+          .lookupFunction<
+            Int32 Function(
+              Pointer<Void>,
+              Uint32,
+              Pointer<Uint8>,
+              Uint32,
+              Pointer<Uint8>,
+              Uint32,
+            ),
+            int Function(
+              Pointer<Void>,
+              int,
+              Pointer<Uint8>,
+              int,
+              Pointer<Uint8>,
+              int,
+            )
+          >('prava_feed_cache_put'),
+      touch = library
+          .lookupFunction<
+            Void Function(Pointer<Void>, Uint32, Pointer<Uint8>, Uint32),
+            void Function(Pointer<Void>, int, Pointer<Uint8>, int)
+          >('prava_feed_cache_touch'),
+      commit = library
+          .lookupFunction<
+            Int32 Function(Pointer<Void>),
+            int Function(Pointer<Void>)
+          >('prava_feed_cache_commit'),
+      clear = library
+          .lookupFunction<
+            Int32 Function(Pointer<Void>),
+            int Function(Pointer<Void>)
+          >('prava_feed_cache_clear'),
+      data = library
+          .lookupFunction<
+            Pointer<Uint8> Function(Pointer<Void>, Pointer<Uint64>),
+            Pointer<Uint8> Function(Pointer<Void>, Pointer<Uint64>)
+          >('prava_feed_snapshot_data'),
+      find = library
+          .lookupFunction<
+            Int32 Function(
+              Pointer<Void>,
+              Uint32,
+              Pointer<Uint8>,
+              Uint32,
+              Pointer<Uint64>,
+              Pointer<Uint32>,
+            ),
+            int Function(
+              Pointer<Void>,
+              int,
+              Pointer<Uint8>,
+              int,
+              Pointer<Uint64>,
+              Pointer<Uint32>,
+            )
+          >('prava_feed_snapshot_find'),
+      releaseSnapshot = library.lookup<NativeFinalizerFunction>(
+        'prava_feed_snapshot_release',
+      );
+
+  static const String _libraryName = 'libprava_feed.so';
+
+  static _FeedCacheBindings? load() {
+    if (!Platform.isLinux) return null;
+    try {
+      return _FeedCacheBindings(DynamicLibrary.open(_libraryName));
+    } catch (_) {
+      return null;
+    }
+  }
+
+  final Pointer<Void> Function(Pointer<Utf8>, int, int) open;
+  final Pointer<Void> Function(Pointer<Void>) snapshot;
+  final int Function(
+    Pointer<Void>,
+    int,
+    Pointer<Uint8>,
+    int,
+    Pointer<Uint8>,
+    int,
+  )
+  put;
+  final void Function(Pointer<Void>, int, Pointer<Uint8>, int) touch;
+  final int Function(Pointer<Void>) commit;
+  final int Function(Pointer<Void>) clear;
+  final Pointer<Uint8> Function(Pointer<Void>, Pointer<Uint64>) data;
+  final int Function(
+    Pointer<Void>,
+    int,
+    Pointer<Uint8>,
+    int,
+    Pointer<Uint64>,
+    Pointer<Uint32>,
+  )
+  find;
+  final Pointer<NativeFinalizerFunction> releaseSnapshot;
+}
@@ -91,6 +91,7 @@ class _ChatThreadPageState extends State<ChatThreadPage> {
   bool _isMuted = false;
   bool _isStarred = false;
   bool _uploadingAttachment = false;
+  double? _attachmentProgress;
   bool _emojiPanelVisible = false;
   ChatMessage? _replyingToMessage;
   final List<String> _recentEmojis = <String>[];
@@ -542,10 +543,13 @@ class _ChatThreadPageState extends State<ChatThreadPage> {
     }
     if (picked == null) return;
 
-    setState(() => _uploadingAttachment = true);
+    setState(() {
+      _uploadingAttachment = true;
+      _attachmentProgress = null;
+    });
     try {
-      final bytes = await picked.readAsBytes();
-      if (bytes.isEmpty) {
+      final byteSize = await picked.length();
+      if (byteSize == 0) {
         throw Exception('empty attachment');
       }
 
@@ -561,20 +565,27 @@ class _ChatThreadPageState extends State<ChatThreadPage> {
         conversationId: widget.chat.id,
         fileName: fileName,
         mimeType: mimeType,
-        byteSize: bytes.length,
+        byteSize: byteSize,
         attachmentType: attachmentType,
       );
       if (init == null || init.attachmentId.isEmpty) {
         throw Exception('attachment init failed');
       }
-      if (init.maxBytes > 0 && bytes.length > init.maxBytes) {
+      if (init.maxBytes > 0 && byteSize > init.maxBytes) {
         throw Exception('attachment too large');
       }
 
-      final dataUri = 'data:$mimeType;base64,${base64Encode(bytes)}';
-      final asset = await _mediaService.uploadChatMedia(
-        dataUri: dataUri,
+      // Content-addressed and resumable: re-sending a file this user
+      // already uploaded sends no bytes.
+      final asset = await _mediaService.uploadChatFile(
+        path: picked.path,
+        mimeType: mimeType,
         resourceType: isVideo ? 'video' : 'image',
+        onProgress: (progress) {
+          if (mounted) {
+            setState(() => _attachmentProgress = progress.fraction);
+          }
+        },
       );
       if (asset.assetId.isEmpty) {
         throw Exception('media upload failed');
@@ -601,7 +612,10 @@ class _ChatThreadPageState extends State<ChatThreadPage> {
       );
     } finally {
       if (mounted) {
-        setState(() => _uploadingAttachment = false);
+        setState(() {
+          _uploadingAttachment = false;
+          _attachmentProgress = null;
+        });
       }
     }
   }
@@ -2543,6 +2557,7 @@ class _ChatThreadPageState extends State<ChatThreadPage> {
                           },
                           onChanged: _handleTypingChanged,
                           isUploading: _uploadingAttachment,
+                          uploadProgress: _attachmentProgress,
                           isEmojiOpen: _emojiPanelVisible,
                         ),
                         AnimatedSwitcher(
@@ -3920,6 +3935,7 @@ class _ComposerBar extends StatelessWidget {
     required this.onSend,
     required this.onChanged,
     required this.isUploading,
+    this.uploadProgress,
     required this.isEmojiOpen,
   });
 
@@ -3930,6 +3946,7 @@ class _ComposerBar extends StatelessWidget {
   final VoidCallback onSend;
   final ValueChanged<String> onChanged;
   final bool isUploading;
+  final double? uploadProgress;
   final bool isEmojiOpen;
 
   @override
@@ -4009,12 +4026,13 @@ class _ComposerBar extends StatelessWidget {
                           ),
                   ),
                   if (isUploading)
-                    const Padding(
-                      padding: EdgeInsets.only(right: 8, bottom: 11),
+                    Padding(
+                      padding: const EdgeInsets.only(right: 8, bottom: 11),
                       child: SizedBox(
                         width: 16,
                         height: 16,
                         child: CircularProgressIndicator(
+                          value: uploadProgress,
                           strokeWidth: 2,
                           color: PravaColors.accentPrimary,
                         ),
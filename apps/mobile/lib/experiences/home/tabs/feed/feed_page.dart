@@ -19,6 +19,7 @@ import '../../../../services/chat_service.dart';
 import '../../../../services/user_search_service.dart';
 import '../../../../services/local_time_service.dart';
 import '../../../../services/platform_bridge_service.dart';
+import '../../../../core/storage/feed_cache.dart';
 import '../../../../core/storage/secure_store.dart';
 import '../profile/public_profile_page.dart';
 
@@ -78,6 +79,9 @@ class _FeedPageState extends State<FeedPage> {
   List<CustomFeed> _customFeeds = <CustomFeed>[];
   FeedPreferences? _preferences;
   bool _loading = true;
+  // Set once the network page for the current load has rendered, so a slower
+  // offline copy never replaces it.
+  bool _networkPageShown = false;
   bool _loadingMore = false;
   bool _posting = false;
   bool _studioLoading = false;
@@ -215,7 +219,12 @@ class _FeedPageState extends State<FeedPage> {
 
   Future<void> _loadFeed({bool showSkeleton = false}) async {
     if (showSkeleton && mounted) {
-      setState(() => _loading = true);
+      setState(() {
+        _loading = true;
+        _networkPageShown = false;
+      });
+      // Not awaited: the fetch must not wait for the cache to open.
+      unawaited(_showCachedFeed());
     }
 
     try {
@@ -234,6 +243,7 @@ class _FeedPageState extends State<FeedPage> {
         _feedSessionId = page['sessionId']?.toString() ?? _feedSessionId;
         _hasMore = _nextCursor != null && _nextCursor!.isNotEmpty;
         _loading = false;
+        _networkPageShown = true;
       });
       _recordPostImpressions(data);
     } catch (_) {
@@ -247,6 +257,30 @@ class _FeedPageState extends State<FeedPage> {
     }
   }
 
+  /// Renders the offline copy of this feed while the network loads.
+  Future<void> _showCachedFeed() async {
+    final mode = _currentFeedMode();
+    try {
+      final page = await _feedService.cachedFeedPage(
+        mode: mode,
+        lens: _currentLens(),
+      );
+      final posts = page?['items'] as List<FeedPost>?;
+      if (!mounted || posts == null || posts.isEmpty) return;
+      if (_networkPageShown || _posts.isNotEmpty) return;
+      if (mode != _currentFeedMode()) return;
+
+      setState(() {
+        _posts = posts;
+        // Cached cursors may be stale; paging resumes after the refresh.
+        _hasMore = false;
+        _loading = false;
+      });
+    } catch (_) {
+      // Offline cache is best effort.
+    }
+  }
+
   Future<void> _refreshFeed() async {
     try {
       final page = await _feedService.listFeedPage(
@@ -3293,7 +3327,7 @@ class _PostCard extends StatelessWidget {
                     radius: 22,
                     backgroundColor: tokens.brandContainer,
                     backgroundImage: post.author.avatarUrl.trim().isNotEmpty
-                        ? NetworkImage(post.author.avatarUrl.trim())
+                        ? _feedAvatarImage(post.author.avatarUrl.trim())
                         : null,
                     child: post.author.avatarUrl.trim().isNotEmpty
                         ? null
@@ -5207,3 +5241,19 @@ class _ShareSheetState extends State<_ShareSheet> {
     );
   }
 }
+
+final Map<String, ImageProvider> _feedAvatarImages = <String, ImageProvider>{};
+
+/// Avatar for a feed post, served from the offline feed cache when it holds
+/// the image so cached pages render without waiting on the network.
+/// Providers are memoized so rebuilds hit Flutter's image cache.
+ImageProvider _feedAvatarImage(String url) {
+  final known = _feedAvatarImages[url];
+  if (known != null) return known;
+  if (_feedAvatarImages.length >= 256) _feedAvatarImages.clear();
+
+  final cached = FeedCache.instance.thumbnail(url);
+  return _feedAvatarImages[url] = cached != null
+      ? MemoryImage(cached)
+      : NetworkImage(url);
+}
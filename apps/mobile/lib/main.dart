@@ -1,10 +1,15 @@
+import 'dart:async';
+
 import 'package:flutter/material.dart';
 
+import 'core/storage/feed_cache.dart';
 import 'shell/app.dart';
 import 'shell/settings_controller.dart';
 
 Future<void> main() async {
   WidgetsFlutterBinding.ensureInitialized();
+  // Map the offline feed cache while settings load, for the first frame.
+  unawaited(FeedCache.instance.open());
   final settingsController = SettingsController();
   await settingsController.load();
   runApp(PravaApp(settingsController: settingsController));
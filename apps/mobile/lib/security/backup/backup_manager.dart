@@ -4,6 +4,7 @@ import 'dart:typed_data';
 import '../crypto/random_generator.dart';
 import '../storage/identity_store.dart';
 import '../storage/prekey_store.dart';
+import '../storage/session_cache.dart';
 import '../storage/session_store.dart';
 import '../storage/signed_prekey_store.dart';
 import '../storage/vault.dart';
@@ -134,6 +135,7 @@ final class BackupManager {
     final payload = BackupPayload.decode(plaintext);
 
     // 7. Clear existing data
+    await SessionCache.clear();
     await Vault.clear();
 
     // 8. Restore data
@@ -79,6 +79,15 @@ final class NativeApi {
   /// Check if native library is available
   static bool get isAvailable => _library != null;
 
+  /// Loaded native library (null in fallback mode)
+  static DynamicLibrary? get library => _library;
+
+  /// Open the native library in the current isolate.
+  ///
+  /// Background isolates do not share [initialize] state, so kernels that
+  /// run under `Isolate.run` open their own handle through this.
+  static DynamicLibrary? openLibrary() => _library ?? _loadLibrary();
+
   /// Get security capabilities
   static NativeCapabilities getCapabilities() {
     return _capabilities ?? const NativeCapabilities.none();
@@ -0,0 +1,179 @@
+// Native sender-key distribution sealing
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import '../ratchet/double_ratchet.dart';
+import 'native_api.dart';
+
+/// ============================================================
+/// Native Group Distribution
+/// ============================================================
+/// FFI binding for linux/native/security/group_distribution.cc:
+///
+/// • Seals one payload for every member device in parallel
+/// • XSalsa20-Poly1305, framed as [RatchetMessage.toBytes]
+/// • Base64 output in one pooled native buffer
+///
+/// Callers advance each pairwise ratchet with
+/// [DoubleRatchet.advanceSending] and pass the steps here; the
+/// result is byte-compatible with [DoubleRatchet.encrypt].
+/// ============================================================
+final class NativeGroupDistribution {
+  NativeGroupDistribution._();
+
+  /// Mirrors DistributionBatch::kMaxDevices
+  static const int maxDevices = 10000;
+
+  /// Mirrors DistributionBatch::kMaxPlaintext
+  static const int maxPlaintext = 256 * 1024;
+
+  static const int _stepSize = 32 + 32 + 4 + 4;
+
+  static _DistributionBindings? _bindings;
+
+  /// Whether the native kernel can be used
+  static bool get isAvailable => NativeApi.isAvailable;
+
+  /// Whether a payload of [plaintextLength] bytes for [deviceCount]
+  /// devices is within the kernel's limits. Check before advancing any
+  /// ratchet: [seal] returns null outside them.
+  static bool canSeal({
+    required int plaintextLength,
+    required int deviceCount,
+  }) {
+    return isAvailable &&
+        deviceCount > 0 &&
+        deviceCount <= maxDevices &&
+        plaintextLength <= maxPlaintext;
+  }
+
+  /// Seal [plaintext] once per step; returns base64 ratchet messages in
+  /// step order, or null if the kernel is unavailable or fails.
+  static NativeDistributionResult? seal({
+    required Uint8List plaintext,
+    required List<RatchetSendStep> steps,
+  }) {
+    final library = NativeApi.library;
+    final withinLimits = canSeal(
+      plaintextLength: plaintext.length,
+      deviceCount: steps.length,
+    );
+    if (library == null || !withinLimits) return null;
+    final bindings = _bindings ??= _DistributionBindings(library);
+
+    final stepBytes = steps.length * _stepSize;
+    final packed = calloc<Uint8>(stepBytes);
+    final message = calloc<Uint8>(plaintext.isEmpty ? 1 : plaintext.length);
+    final stride = calloc<Uint32>();
+    final timings = calloc<_DistributionTimings>();
+    Pointer<Void> batch = nullptr;
+    try {
+      final view = packed.asTypedList(stepBytes);
+      final data = ByteData.sublistView(view);
+      for (var i = 0; i < steps.length; i++) {
+        final step = steps[i];
+        final offset = i * _stepSize;
+        view.setAll(offset, step.messageKey);
+        view.setAll(offset + 32, step.ratchetPublicKey);
+        data.setUint32(offset + 64, step.messageNumber);
+        data.setUint32(offset + 68, step.previousChainLength);
+      }
+      message.asTypedList(plaintext.length).setAll(0, plaintext);
+
+      batch = bindings.seal(message, plaintext.length, packed, steps.length);
+      if (batch == nullptr) return null;
+
+      final base = bindings.envelopes(batch, stride).cast<Uint8>();
+      final width = stride.value;
+      final all = base.asTypedList(width * steps.length);
+      final envelopes = List<String>.generate(
+        steps.length,
+        (i) => latin1.decode(
+          Uint8List.sublistView(all, i * width, (i + 1) * width - 1),
+        ),
+      );
+
+      bindings.timings(batch, timings);
+      final t = timings.ref;
+      return NativeDistributionResult(
+        envelopes: envelopes,
+        seal: Duration(microseconds: t.sealNs ~/ 1000),
+        total: Duration(microseconds: t.totalNs ~/ 1000),
+        threads: t.threads,
+      );
+    } finally {
+      packed.asTypedList(stepBytes).fillRange(0, stepBytes, 0);
+      calloc.free(packed);
+      calloc.free(message);
+      calloc.free(stride);
+      calloc.free(timings);
+      if (batch != nullptr) bindings.free(batch);
+    }
+  }
+}
+
+/// Result of a native distribution batch
+class NativeDistributionResult {
+  /// Base64 ratchet messages, one per step
+  final List<String> envelopes;
+
+  final Duration seal;
+  final Duration total;
+  final int threads;
+
+  const NativeDistributionResult({
+    required this.envelopes,
+    required this.seal,
+    required this.total,
+    required this.threads,
+  });
+}
+
+/// Mirrors PravaDistributionTimings
+final class _DistributionTimings extends Struct {
+  @Uint64()
+  external int sealNs;
+
+  @Uint64()
+  external int totalNs;
+
+  @Uint32()
+  external int threads;
+}
+
+final class _DistributionBindings {
+  _DistributionBindings(DynamicLibrary library)
+    : seal = library
+          .lookupFunction<
+            Pointer<Void> Function(
+              Pointer<Uint8>,
+              Uint32,
+              Pointer<Uint8>,
+              Uint32,
+            ),
+            Pointer<Void> Function(Pointer<Uint8>, int, Pointer<Uint8>, int)
+          >('prava_distribution_seal'),
+      envelopes = library
+          .lookupFunction<
+            Pointer<Utf8> Function(Pointer<Void>, Pointer<Uint32>),
+            Pointer<Utf8> Function(Pointer<Void>, Pointer<Uint32>)
+          >('prava_distribution_envelopes'),
+      timings = library
+          .lookupFunction<
+            Void Function(Pointer<Void>, Pointer<_DistributionTimings>),
+            void Function(Pointer<Void>, Pointer<_DistributionTimings>)
+          >('prava_distribution_timings'),
+      free = library
+          .lookupFunction<
+            Void Function(Pointer<Void>),
+            void Function(Pointer<Void>)
+          >('prava_distribution_free');
+
+  final Pointer<Void> Function(Pointer<Uint8>, int, Pointer<Uint8>, int) seal;
+  final Pointer<Utf8> Function(Pointer<Void>, Pointer<Uint32>) envelopes;
+  final void Function(Pointer<Void>, Pointer<_DistributionTimings>) timings;
+  final void Function(Pointer<Void>) free;
+}
@@ -0,0 +1,271 @@
+// Native batch prekey generation
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import '../storage/prekey_store.dart';
+import 'native_api.dart';
+
+/// ============================================================
+/// Native PreKey Batch
+/// ============================================================
+/// FFI binding for linux/native/security/prekey_batch.cc:
+///
+/// • Generates one-time prekeys across all cores
+/// • Generates and signs the signed prekey in the same call
+/// • Serializes the `oneTimePreKeys` upload array natively
+/// • Reports per-phase timing counters
+///
+/// Runs on a background isolate so replenishment never blocks
+/// the UI isolate. Returns null when the native library is not
+/// bundled; callers fall back to [KeyGeneration].
+/// ============================================================
+final class NativePreKeys {
+  NativePreKeys._();
+
+  /// Mirrors PrekeyBatch::kMaxCount
+  static const int maxBatchSize = 1000;
+
+  static const int _keySize = 32;
+  static const int _signatureSize = 64;
+  static const int _recordSize = 4 + _keySize + _keySize;
+
+  /// Whether the native kernel can be used
+  static bool get isAvailable => NativeApi.isAvailable;
+
+  /// Generate a prekey batch off the UI isolate
+  ///
+  /// [signedKeyId] and [identitySecretKey] (Ed25519, 64 bytes) are
+  /// required together to also produce a new signed prekey.
+  static Future<NativePreKeyBatch?> generate({
+    required int startId,
+    required int count,
+    int? signedKeyId,
+    Uint8List? identitySecretKey,
+  }) async {
+    if (!isAvailable) return null;
+    if (count < 0 || count > maxBatchSize) {
+      throw ArgumentError('Count must be 0-$maxBatchSize: $count');
+    }
+    if (signedKeyId != null && identitySecretKey?.length != 64) {
+      throw ArgumentError('Identity secret key must be 64 bytes');
+    }
+
+    return Isolate.run(
+      () => _generateSync(
+        startId: startId,
+        count: count,
+        signedKeyId: signedKeyId ?? 0,
+        identitySecretKey: identitySecretKey,
+      ),
+    );
+  }
+
+  static NativePreKeyBatch? _generateSync({
+    required int startId,
+    required int count,
+    required int signedKeyId,
+    required Uint8List? identitySecretKey,
+  }) {
+    final library = NativeApi.openLibrary();
+    if (library == null) return null;
+    final bindings = _PreKeyBindings(library);
+
+    Pointer<Uint8> secretKey = nullptr;
+    if (identitySecretKey != null) {
+      secretKey = calloc<Uint8>(identitySecretKey.length);
+      secretKey
+          .asTypedList(identitySecretKey.length)
+          .setAll(0, identitySecretKey);
+    }
+
+    final batch = bindings.generate(startId, count, secretKey, signedKeyId);
+    if (secretKey != nullptr) {
+      final length = identitySecretKey!.length;
+      secretKey.asTypedList(length).fillRange(0, length, 0);
+      calloc.free(secretKey);
+    }
+    if (batch == nullptr) return null;
+
+    final length = calloc<Uint32>();
+    final timings = calloc<_PrekeyBatchTimings>();
+    try {
+      final total = bindings.count(batch);
+      final records = total == 0
+          ? Uint8List(0)
+          : bindings.records(batch).asTypedList(total * _recordSize);
+      final view = ByteData.sublistView(records);
+
+      final preKeys = List<PreKeyData>.generate(total, (i) {
+        final offset = i * _recordSize;
+        return PreKeyData(
+          keyId: view.getUint32(offset, Endian.little),
+          publicKey: Uint8List.fromList(
+            records.sublist(offset + 4, offset + 4 + _keySize),
+          ),
+          privateKey: Uint8List.fromList(
+            records.sublist(offset + 4 + _keySize, offset + _recordSize),
+          ),
+        );
+      });
+
+      SignedPreKeyData? signedPreKey;
+      final signedRecord = bindings.signedRecord(batch);
+      if (signedRecord != nullptr) {
+        final bytes = signedRecord.asTypedList(_recordSize + _signatureSize);
+        signedPreKey = SignedPreKeyData(
+          keyId: ByteData.sublistView(bytes).getUint32(0, Endian.little),
+          publicKey: Uint8List.fromList(bytes.sublist(4, 4 + _keySize)),
+          privateKey: Uint8List.fromList(
+            bytes.sublist(4 + _keySize, _recordSize),
+          ),
+          signature: Uint8List.fromList(bytes.sublist(_recordSize)),
+        );
+      }
+
+      final json = bindings.uploadJson(batch, length);
+      final uploadJson = utf8.decode(
+        json.cast<Uint8>().asTypedList(length.value),
+      );
+
+      bindings.timings(batch, timings);
+      final t = timings.ref;
+
+      return NativePreKeyBatch(
+        preKeys: preKeys,
+        signedPreKey: signedPreKey,
+        uploadJson: uploadJson,
+        timings: PreKeyBatchTimings(
+          keygen: Duration(microseconds: t.keygenNs ~/ 1000),
+          sign: Duration(microseconds: t.signNs ~/ 1000),
+          serialize: Duration(microseconds: t.serializeNs ~/ 1000),
+          total: Duration(microseconds: t.totalNs ~/ 1000),
+          threads: t.threads,
+        ),
+      );
+    } finally {
+      calloc.free(length);
+      calloc.free(timings);
+      bindings.free(batch);
+    }
+  }
+}
+
+/// Result of a native batch generation
+class NativePreKeyBatch {
+  /// One-time prekeys, ready for [PreKeyStore.saveReplenishment]
+  final List<PreKeyData> preKeys;
+
+  /// Freshly signed prekey (null when rotation was not requested)
+  final SignedPreKeyData? signedPreKey;
+
+  /// JSON array of `{keyId, publicKey}` for [preKeys]
+  final String uploadJson;
+
+  /// Native timing counters
+  final PreKeyBatchTimings timings;
+
+  const NativePreKeyBatch({
+    required this.preKeys,
+    required this.signedPreKey,
+    required this.uploadJson,
+    required this.timings,
+  });
+
+  /// Key IDs covered by [uploadJson], in order
+  List<int> get keyIds => preKeys.map((key) => key.keyId).toList();
+}
+
+/// Per-phase timing counters of a native batch
+class PreKeyBatchTimings {
+  final Duration keygen;
+  final Duration sign;
+  final Duration serialize;
+  final Duration total;
+  final int threads;
+
+  const PreKeyBatchTimings({
+    required this.keygen,
+    required this.sign,
+    required this.serialize,
+    required this.total,
+    required this.threads,
+  });
+
+  @override
+  String toString() =>
+      'PreKeyBatchTimings('
+      'keygen: ${keygen.inMicroseconds}us, '
+      'sign: ${sign.inMicroseconds}us, '
+      'serialize: ${serialize.inMicroseconds}us, '
+      'total: ${total.inMicroseconds}us, '
+      'threads: $threads)';
+}
+
+/// Mirrors PravaPrekeyBatchTimings
+final class _PrekeyBatchTimings extends Struct {
+  @Uint64()
+  external int keygenNs;
+
+  @Uint64()
+  external int signNs;
+
+  @Uint64()
+  external int serializeNs;
+
+  @Uint64()
+  external int totalNs;
+
+  @Uint32()
+  external int threads;
+}
+
+final class _PreKeyBindings {
+  _PreKeyBindings(DynamicLibrary library)
+    : generate = library
+          .lookupFunction<
+            Pointer<Void> Function(Uint32, Uint32, Pointer<Uint8>, Uint32),
+            Pointer<Void> Function(int, int, Pointer<Uint8>, int)
+          >('prava_prekey_batch_generate'),
+      count = library
+          .lookupFunction<
+            Uint32 Function(Pointer<Void>),
+            int Function(Pointer<Void>)
+          >('prava_prekey_batch_count'),
+      records = library
+          .lookupFunction<
+            Pointer<Uint8> Function(Pointer<Void>),
+            Pointer<Uint8> Function(Pointer<Void>)
+          >('prava_prekey_batch_records'),
+      signedRecord = library
+          .lookupFunction<
+            Pointer<Uint8> Function(Pointer<Void>),
+            Pointer<Uint8> Function(Pointer<Void>)
+          >('prava_prekey_batch_signed_record'),
+      uploadJson = library
+          .lookupFunction<
+            Pointer<Utf8> Function(Pointer<Void>, Pointer<Uint32>),
+            Pointer<Utf8> Function(Pointer<Void>, Pointer<Uint32>)
+          >('prava_prekey_batch_upload_json'),
+      timings = library
+          .lookupFunction<
+            Void Function(Pointer<Void>, Pointer<_PrekeyBatchTimings>),
+            void Function(Pointer<Void>, Pointer<_PrekeyBatchTimings>)
+          >('prava_prekey_batch_timings'),
+      free = library
+          .lookupFunction<
+            Void Function(Pointer<Void>),
+            void Function(Pointer<Void>)
+          >('prava_prekey_batch_free');
+
+  final Pointer<Void> Function(int, int, Pointer<Uint8>, int) generate;
+  final int Function(Pointer<Void>) count;
+  final Pointer<Uint8> Function(Pointer<Void>) records;
+  final Pointer<Uint8> Function(Pointer<Void>) signedRecord;
+  final Pointer<Utf8> Function(Pointer<Void>, Pointer<Uint32>) uploadJson;
+  final void Function(Pointer<Void>, Pointer<_PrekeyBatchTimings>) timings;
+  final void Function(Pointer<Void>) free;
+}
@@ -0,0 +1,412 @@
+// Native write-behind session cache
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import 'native_api.dart';
+
+/// ============================================================
+/// Native Session Cache
+/// ============================================================
+/// FFI binding for linux/native/security/session_cache.cc:
+///
+/// • LRU of encoded session records in mlocked memory; journal
+///   and compaction copies stay in sodium_malloc buffers too
+/// • Checksummed append-only journal, replayed on open; a
+///   failed append is rolled back and compacted away
+/// • Group fdatasync: many ratchet steps, one durable write
+/// • Dirty records drained in one buffer for a single Isar txn
+///
+/// Records are opaque bytes here; [SessionCache] owns the
+/// encoding and the flush policy.
+/// ============================================================
+final class NativeSessionCache {
+  NativeSessionCache._(this._bindings, this._handle);
+
+  /// Initial record read buffer; larger records retry once
+  static const int _readBufferSize = 4096;
+
+  final _SessionCacheBindings _bindings;
+  Pointer<Void> _handle;
+
+  /// Open (and replay) the journal at [journalPath]
+  ///
+  /// [syncInterval] bounds how long an appended record may stay
+  /// in the page cache before fdatasync; zero syncs every append.
+  static NativeSessionCache? open({
+    required String journalPath,
+    required int capacity,
+    required Duration syncInterval,
+  }) {
+    final library = NativeApi.library;
+    if (library == null) return null;
+    final bindings = _SessionCacheBindings(library);
+
+    final path = journalPath.toNativeUtf8(allocator: calloc);
+    try {
+      final handle = bindings.open(
+        path,
+        capacity,
+        syncInterval.inMilliseconds,
+      );
+      if (handle == nullptr) return null;
+      return NativeSessionCache._(bindings, handle);
+    } finally {
+      calloc.free(path);
+    }
+  }
+
+  bool get isOpen => _handle != nullptr;
+
+  /// Cached record for [key], or null on a miss
+  Uint8List? get(String key) {
+    if (!isOpen) return null;
+    final keyBytes = utf8.encode(key);
+    final nativeKey = _copyIn(keyBytes);
+    final length = calloc<Uint32>();
+    var capacity = _readBufferSize;
+    var out = calloc<Uint8>(capacity);
+    try {
+      var result = _bindings.get(
+        _handle,
+        nativeKey,
+        keyBytes.length,
+        out,
+        capacity,
+        length,
+      );
+      if (result < 0) {
+        calloc.free(out);
+        capacity = length.value;
+        out = calloc<Uint8>(capacity);
+        result = _bindings.get(
+          _handle,
+          nativeKey,
+          keyBytes.length,
+          out,
+          capacity,
+          length,
+        );
+      }
+      if (result != 1) return null;
+      return Uint8List.fromList(out.asTypedList(length.value));
+    } finally {
+      out.asTypedList(capacity).fillRange(0, capacity, 0);
+      calloc.free(out);
+      calloc.free(length);
+      calloc.free(nativeKey);
+    }
+  }
+
+  /// Overwrite [key] and journal it
+  ///
+  /// Returns false if the change is cached but not crash-safe;
+  /// the caller should flush to Isar.
+  bool put(String key, Uint8List value) =>
+      _write(key, value, _bindings.put);
+
+  /// Cache a record just read from Isar (clean, not journaled)
+  bool prime(String key, Uint8List value) =>
+      _write(key, value, _bindings.prime);
+
+  /// Drop [key] and journal a tombstone
+  bool remove(String key) {
+    if (!isOpen) return false;
+    final keyBytes = utf8.encode(key);
+    final nativeKey = _copyIn(keyBytes);
+    try {
+      return _bindings.remove(_handle, nativeKey, keyBytes.length) != 0;
+    } finally {
+      calloc.free(nativeKey);
+    }
+  }
+
+  /// Drop every record and empty the journal
+  bool clear() => isOpen && _bindings.clear(_handle) != 0;
+
+  /// Snapshot of every record not yet in Isar
+  SessionCacheDirty takeDirty() {
+    final out = calloc<Pointer<Uint8>>();
+    final size = calloc<Uint32>();
+    final count = calloc<Uint32>();
+    try {
+      final generation = _bindings.takeDirty(_handle, out, size, count);
+      final records = <String, Uint8List>{};
+      if (out.value != nullptr) {
+        final bytes = out.value.asTypedList(size.value);
+        final view = ByteData.sublistView(bytes);
+        var offset = 0;
+        for (var i = 0; i < count.value; i++) {
+          final keyLength = view.getUint32(offset, Endian.little);
+          final key = utf8.decode(
+            Uint8List.sublistView(bytes, offset + 4, offset + 4 + keyLength),
+          );
+          offset += 4 + keyLength;
+          final valueLength = view.getUint32(offset, Endian.little);
+          records[key] = Uint8List.fromList(
+            Uint8List.sublistView(bytes, offset + 4, offset + 4 + valueLength),
+          );
+          offset += 4 + valueLength;
+        }
+        _bindings.release(out.value);
+      }
+      return SessionCacheDirty(generation: generation, records: records);
+    } finally {
+      calloc.free(out);
+      calloc.free(size);
+      calloc.free(count);
+    }
+  }
+
+  /// Mark everything up to [generation] persisted; the journal is
+  /// compacted natively in the background once it grows large
+  bool checkpoint(int generation) =>
+      isOpen && _bindings.checkpoint(_handle, generation) != 0;
+
+  SessionCacheStats stats() {
+    final out = calloc<_SessionCacheStats>();
+    try {
+      if (isOpen) _bindings.stats(_handle, out);
+      final s = out.ref;
+      return SessionCacheStats(
+        hits: s.hits,
+        misses: s.misses,
+        puts: s.puts,
+        evictions: s.evictions,
+        journalBytes: s.journalBytes,
+        journalSyncs: s.journalSyncs,
+        checkpoints: s.checkpoints,
+        entries: s.entries,
+        dirty: s.dirty,
+      );
+    } finally {
+      calloc.free(out);
+    }
+  }
+
+  /// Sync the journal and wipe cached records
+  void close() {
+    if (!isOpen) return;
+    _bindings.close(_handle);
+    _handle = nullptr;
+  }
+
+  bool _write(String key, Uint8List value, _WriteDart call) {
+    if (!isOpen) return false;
+    final keyBytes = utf8.encode(key);
+    final nativeKey = _copyIn(keyBytes);
+    final nativeValue = _copyIn(value);
+    try {
+      return call(
+            _handle,
+            nativeKey,
+            keyBytes.length,
+            nativeValue,
+            value.length,
+          ) !=
+          0;
+    } finally {
+      nativeValue.asTypedList(value.length).fillRange(0, value.length, 0);
+      calloc.free(nativeValue);
+      calloc.free(nativeKey);
+    }
+  }
+
+  static Pointer<Uint8> _copyIn(List<int> bytes) {
+    final pointer = calloc<Uint8>(bytes.isEmpty ? 1 : bytes.length);
+    pointer.asTypedList(bytes.length).setAll(0, bytes);
+    return pointer;
+  }
+}
+
+/// Dirty records drained by [NativeSessionCache.takeDirty]
+class SessionCacheDirty {
+  /// Pass to [NativeSessionCache.checkpoint] once persisted
+  final int generation;
+
+  /// Encoded records by session ID
+  final Map<String, Uint8List> records;
+
+  const SessionCacheDirty({required this.generation, required this.records});
+}
+
+/// Native cache counters
+class SessionCacheStats {
+  final int hits;
+  final int misses;
+  final int puts;
+  final int evictions;
+  final int journalBytes;
+  final int journalSyncs;
+  final int checkpoints;
+  final int entries;
+  final int dirty;
+
+  const SessionCacheStats({
+    required this.hits,
+    required this.misses,
+    required this.puts,
+    required this.evictions,
+    required this.journalBytes,
+    required this.journalSyncs,
+    required this.checkpoints,
+    required this.entries,
+    required this.dirty,
+  });
+
+  @override
+  String toString() =>
+      'SessionCacheStats('
+      'hits: $hits, misses: $misses, puts: $puts, '
+      'evictions: $evictions, journalBytes: $journalBytes, '
+      'journalSyncs: $journalSyncs, checkpoints: $checkpoints, '
+      'entries: $entries, dirty: $dirty)';
+}
+
+/// Mirrors PravaSessionCacheStats
+final class _SessionCacheStats extends Struct {
+  @Uint64()
+  external int hits;
+
+  @Uint64()
+  external int misses;
+
+  @Uint64()
+  external int puts;
+
+  @Uint64()
+  external int evictions;
+
+  @Uint64()
+  external int journalBytes;
+
+  @Uint64()
+  external int journalSyncs;
+
+  @Uint64()
+  external int checkpoints;
+
+  @Uint32()
+  external int entries;
+
+  @Uint32()
+  external int dirty;
+}
+
+typedef _WriteNative =
+    Int32 Function(
+      Pointer<Void>,
+      Pointer<Uint8>,
+      Uint32,
+      Pointer<Uint8>,
+      Uint32,
+    );
+typedef _WriteDart =
+    int Function(Pointer<Void>, Pointer<Uint8>, int, Pointer<Uint8>, int);
+
+final class _SessionCacheBindings {
+  _SessionCacheBindings(DynamicLibrary library)
+    : open = library
+          .lookupFunction<
+            Pointer<Void> Function(Pointer<Utf8>, Uint32, Uint32),
+            Pointer<Void> Function(Pointer<Utf8>, int, int)
+          >('prava_session_cache_open'),
+      get = library
+          .lookupFunction<
+            Int32 Function(
+              Pointer<Void>,
+              Pointer<Uint8>,
+              Uint32,
+              Pointer<Uint8>,
+              Uint32,
+              Pointer<Uint32>,
+            ),
+            int Function(
+              Pointer<Void>,
+              Pointer<Uint8>,
+              int,
+              Pointer<Uint8>,
+              int,
+              Pointer<Uint32>,
+            )
+          >('prava_session_cache_get'),
+      put = library.lookupFunction<_WriteNative, _WriteDart>(
+        'prava_session_cache_put',
+      ),
+      prime = library.lookupFunction<_WriteNative, _WriteDart>(
+        'prava_session_cache_prime',
+      ),
+      remove = library
+          .lookupFunction<
+            Int32 Function(Pointer<Void>, Pointer<Uint8>, Uint32),
+            int Function(Pointer<Void>, Pointer<Uint8>, int)
+          >('prava_session_cache_remove'),
+      clear = library
+          .lookupFunction<
+            Int32 Function(Pointer<Void>),
+            int Function(Pointer<Void>)
+          >('prava_session_cache_clear'),
+      takeDirty = library
+          .lookupFunction<
+            Uint64 Function(
+              Pointer<Void>,
+              Pointer<Pointer<Uint8>>,
+              Pointer<Uint32>,
+              Pointer<Uint32>,
+            ),
+            int Function(
+              Pointer<Void>,
+              Pointer<Pointer<Uint8>>,
+              Pointer<Uint32>,
+              Pointer<Uint32>,
+            )
+          >('prava_session_cache_take_dirty'),
+      release = library
+          .lookupFunction<
+            Void Function(Pointer<Uint8>),
+            void Function(Pointer<Uint8>)
+          >('prava_session_cache_release'),
+      checkpoint = library
+          .lookupFunction<
+            Int32 Function(Pointer<Void>, Uint64),
+            int Function(Pointer<Void>, int)
+          >('prava_session_cache_checkpoint'),
+      stats = library
+          .lookupFunction<
+            Void Function(Pointer<Void>, Pointer<_SessionCacheStats>),
+            void Function(Pointer<Void>, Pointer<_SessionCacheStats>)
+          >('prava_session_cache_stats'),
+      close = library
+          .lookupFunction<
+            Void Function(Pointer<Void>),
+            void Function(Pointer<Void>)
+          >('prava_session_cache_close');
+
+  final Pointer<Void> Function(Pointer<Utf8>, int, int) open;
+  final int Function(
+    Pointer<Void>,
+    Pointer<Uint8>,
+    int,
+    Pointer<Uint8>,
+    int,
+    Pointer<Uint32>,
+  )
+  get;
+  final _WriteDart put;
+  final _WriteDart prime;
+  final int Function(Pointer<Void>, Pointer<Uint8>, int) remove;
+  final int Function(Pointer<Void>) clear;
+  final int Function(
+    Pointer<Void>,
+    Pointer<Pointer<Uint8>>,
+    Pointer<Uint32>,
+    Pointer<Uint32>,
+  )
+  takeDirty;
+  final void Function(Pointer<Uint8>) release;
+  final int Function(Pointer<Void>, int) checkpoint;
+  final void Function(Pointer<Void>, Pointer<_SessionCacheStats>) stats;
+  final void Function(Pointer<Void>) close;
+}
@@ -201,6 +201,39 @@ final class DoubleRatchet {
     return RatchetEncryptResult(message: message, messageKey: messageKey);
   }
 
+  /// Advance the sending chain without encrypting
+  ///
+  /// For batch sealing (see NativeGroupDistribution): the caller encrypts
+  /// with the returned message key and frames the result exactly like
+  /// [encrypt]. The key is kept as a persistent key, as [encrypt] does.
+  Future<RatchetSendStep> advanceSending() async {
+    if (_sendingChainKey == null) {
+      throw RatchetException('No sending chain key available');
+    }
+
+    final advance = await _sendingChainKey!.advance();
+    _sendingChainKey = advance.nextChainKey;
+
+    final messageKey = Uint8List.fromList(advance.messageKey);
+    _skippedKeys.storePersistentKey(
+      _myRatchetKeyPair!.publicKey,
+      _sendingChainLength,
+      advance.messageKey,
+    );
+    advance.disposeMessageKey();
+
+    final step = RatchetSendStep(
+      messageKey: messageKey,
+      ratchetPublicKey: _myRatchetKeyPair!.publicKey,
+      messageNumber: _sendingChainLength,
+      previousChainLength: _previousSendingChainLength,
+    );
+
+    _sendingChainLength++;
+
+    return step;
+  }
+
   /// Encrypt with associated data (AEAD)
   Future<RatchetMessage> encryptWithAD(
     Uint8List plaintext,
@@ -617,6 +650,26 @@ class RatchetEncryptResult {
   const RatchetEncryptResult({required this.message, required this.messageKey});
 }
 
+class RatchetSendStep {
+  final Uint8List messageKey;
+  final Uint8List ratchetPublicKey;
+  final int messageNumber;
+  final int previousChainLength;
+
+  const RatchetSendStep({
+    required this.messageKey,
+    required this.ratchetPublicKey,
+    required this.messageNumber,
+    required this.previousChainLength,
+  });
+
+  void disposeMessageKey() {
+    for (var i = 0; i < messageKey.length; i++) {
+      messageKey[i] = 0;
+    }
+  }
+}
+
 class RatchetDecryptResult {
   final Uint8List plaintext;
   final Uint8List messageKey;
@@ -5,6 +5,7 @@ import 'dart:io';
 import 'bridge/sodium_loader.dart';
 import 'bridge/memory_allocator.dart';
 import 'bridge/native_api.dart';
+import 'storage/session_cache.dart';
 import 'storage/vault.dart';
 import 'threat/root_detection.dart';
 import 'threat/debugger_check.dart';
@@ -136,6 +137,17 @@ final class SecurityInit {
         );
       }
 
+      // 3.2 Write-behind session cache (optional; replays its
+      // journal into the vault, falls back to Isar when absent)
+      try {
+        final cached = await SessionCache.open(directory: Vault.directory!);
+        if (!cached && Platform.isLinux) {
+          warnings.add('Session cache unavailable; using direct writes');
+        }
+      } catch (e) {
+        warnings.add('Session cache recovery failed: $e');
+      }
+
       // ─────────────────────────────────────────────────────
       // Phase 4:  Finalization
       // ─────────────────────────────────────────────────────
@@ -175,7 +187,8 @@ final class SecurityInit {
     // Clear all sensitive data from memory
     MemoryAllocator.cleanupAll();
 
-    // Close secure storage
+    // Write back cached sessions, then close secure storage
+    await SessionCache.close();
     await Vault.close();
 
     _initialized = false;
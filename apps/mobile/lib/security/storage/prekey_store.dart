@@ -4,6 +4,7 @@ import 'dart:typed_data';
 import 'package:isar/isar.dart';
 
 import '../entities/prekey_entity.dart';
+import '../entities/signed_prekey_entity.dart';
 import 'vault.dart';
 
 /// ============================================================
@@ -72,6 +73,51 @@ final class PreKeyStore {
     });
   }
 
+  /// Save a replenishment batch in a single write transaction
+  ///
+  /// Persists the one-time pre-keys and, when given, rotates the active
+  /// signed pre-key, so a crash cannot leave only half of a batch stored.
+  static Future<void> saveReplenishment({
+    required List<PreKeyData> preKeys,
+    SignedPreKeyData? signedPreKey,
+  }) async {
+    final now = DateTime.now().millisecondsSinceEpoch;
+    final entities = preKeys.map((pk) {
+      return PreKeyEntity()
+        ..keyId = pk.keyId
+        ..publicKey = pk.publicKey.toList()
+        ..privateKey = pk.privateKey.toList()
+        ..uploaded = false
+        ..consumed = false
+        ..createdAt = now;
+    }).toList();
+
+    await Vault.write((db) async {
+      if (signedPreKey != null) {
+        final current = await db.signedPreKeyEntitys
+            .filter()
+            .isActiveEqualTo(true)
+            .findAll();
+        for (final entity in current) {
+          entity.isActive = false;
+        }
+        await db.signedPreKeyEntitys.putAll([
+          ...current,
+          SignedPreKeyEntity()
+            ..keyId = signedPreKey.keyId
+            ..publicKey = signedPreKey.publicKey.toList()
+            ..privateKey = signedPreKey.privateKey.toList()
+            ..signature = signedPreKey.signature.toList()
+            ..isActive = true
+            ..createdAt = now,
+        ]);
+      }
+      if (entities.isNotEmpty) {
+        await db.preKeyEntitys.putAll(entities);
+      }
+    });
+  }
+
   /// Consume pre-key (mark as used and return private key)
   static Future<Uint8List?> consumePreKey(int keyId) async {
     return Vault.write((db) async {
@@ -190,3 +236,18 @@ class PreKeyData {
     required this.privateKey,
   });
 }
+
+/// Signed pre-key data for batch operations
+class SignedPreKeyData {
+  final int keyId;
+  final Uint8List publicKey;
+  final Uint8List privateKey;
+  final Uint8List signature;
+
+  const SignedPreKeyData({
+    required this.keyId,
+    required this.publicKey,
+    required this.privateKey,
+    required this.signature,
+  });
+}
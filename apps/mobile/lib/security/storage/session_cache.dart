@@ -0,0 +1,288 @@
+// Write-behind session cache
+import 'dart:async';
+import 'dart:convert';
+import 'dart:typed_data';
+
+import '../bridge/native_session_cache.dart';
+import '../entities/session_entity.dart';
+import 'vault.dart';
+
+/// ============================================================
+/// Session Cache
+/// ============================================================
+/// Keeps hot Double Ratchet sessions out of the per-message
+/// Isar write path:
+///
+/// • Reads hit a native LRU instead of an Isar query
+/// • Each ratchet step overwrites the cached record in place
+///   and is journaled (crash-safe) instead of a write txn
+/// • Dirty records reach Isar in one batched txn per flush
+///
+/// Falls back to plain Isar when the native library is not
+/// bundled; [SessionStore] checks [isOpen] on every call.
+/// ============================================================
+final class SessionCache {
+  SessionCache._();
+
+  static const String _journalName = 'prava_sessions.journal';
+
+  /// Sessions kept decoded in memory (dirty ones are pinned)
+  static const int defaultCapacity = 256;
+
+  /// Upper bound on journal data not yet fdatasync'ed
+  static const Duration defaultSyncInterval = Duration(milliseconds: 25);
+
+  /// How often dirty records are written back to Isar
+  static const Duration defaultFlushInterval = Duration(seconds: 2);
+
+  /// Dirty records that trigger an early write-back
+  static const int _flushThreshold = 128;
+
+  static NativeSessionCache? _native;
+  static Timer? _flushTimer;
+  static Future<void>? _flushing;
+  static int _pending = 0;
+
+  static bool get isOpen => _native?.isOpen ?? false;
+
+  /// Open the journal next to the vault and replay it
+  ///
+  /// Call after [Vault.initialize]. Records recovered from a
+  /// previous run are written back to Isar before returning.
+  static Future<bool> open({
+    required String directory,
+    int capacity = defaultCapacity,
+    Duration syncInterval = defaultSyncInterval,
+    Duration flushInterval = defaultFlushInterval,
+  }) async {
+    if (isOpen) return true;
+    final native = NativeSessionCache.open(
+      journalPath: '$directory/$_journalName',
+      capacity: capacity,
+      syncInterval: syncInterval,
+    );
+    if (native == null) return false;
+
+    _native = native;
+    _pending = native.stats().dirty;
+    await flush();
+    _flushTimer = Timer.periodic(flushInterval, (_) => _flushInBackground());
+    return true;
+  }
+
+  /// Write back, sync and release the native cache
+  static Future<void> close() async {
+    if (!isOpen) return;
+    _flushTimer?.cancel();
+    _flushTimer = null;
+    await flush();
+    _native!.close();
+    _native = null;
+    _pending = 0;
+  }
+
+  /// Cached entity for [sessionId], or null on a miss
+  static SessionEntity? get(String sessionId) {
+    final record = _native?.get(sessionId);
+    if (record == null) return null;
+    return _SessionRecord.decode(sessionId, record);
+  }
+
+  /// Cache an entity just read from Isar
+  static void prime(SessionEntity entity) {
+    _native?.prime(entity.sessionId, _SessionRecord.encode(entity));
+  }
+
+  /// Store [entity]; Isar is updated by a later flush
+  ///
+  /// Returns false when the cache is closed or could not hold
+  /// the record, in which case the caller writes Isar directly.
+  static bool put(SessionEntity entity) {
+    final native = _native;
+    if (native == null || !native.isOpen) return false;
+
+    final record = _SessionRecord.encode(entity);
+    _pending++;
+    if (!native.put(entity.sessionId, record)) {
+      // Either not cached at all, or cached but not journaled:
+      // write back now so Isar and the journal agree again.
+      final cached = native.get(entity.sessionId) != null;
+      _flushInBackground();
+      return cached;
+    }
+    if (_pending >= _flushThreshold) _flushInBackground();
+    return true;
+  }
+
+  /// Drop [sessionId] before it is deleted from Isar
+  ///
+  /// Waits for an in-flight write-back so it cannot re-insert
+  /// the session after the delete.
+  static Future<void> remove(String sessionId) async {
+    final native = _native;
+    if (native == null || !native.isOpen) return;
+    await _settle();
+    if (!native.remove(sessionId)) {
+      _pending++;
+      await flush();
+    }
+  }
+
+  /// Forget everything (vault cleared or restored)
+  static Future<void> clear() async {
+    if (!isOpen) return;
+    await _settle();
+    _native!.clear();
+    _pending = 0;
+  }
+
+  /// Write every dirty record to Isar in one transaction
+  static Future<void> flush() async {
+    await _settle();
+    if (!isOpen || _pending == 0) return;
+
+    final flushing = _writeBack();
+    _flushing = flushing;
+    try {
+      await flushing;
+    } finally {
+      _flushing = null;
+    }
+  }
+
+  static SessionCacheStats? stats() => isOpen ? _native!.stats() : null;
+
+  /// Wait out any in-flight write-back, ignoring its outcome
+  static Future<void> _settle() async {
+    while (_flushing != null) {
+      await _flushing!.catchError((Object _) {});
+    }
+  }
+
+  static void _flushInBackground() {
+    if (_pending == 0 || _flushing != null) return;
+    unawaited(flush().catchError((Object _) {}));
+  }
+
+  static Future<void> _writeBack() async {
+    final native = _native!;
+    final pending = _pending;
+    _pending = 0;
+    final dirty = native.takeDirty();
+
+    try {
+      if (dirty.records.isNotEmpty) {
+        final entities = [
+          for (final entry in dirty.records.entries)
+            _SessionRecord.decode(entry.key, entry.value),
+        ];
+        await Vault.write((db) async {
+          await db.sessionEntitys.putAllBySessionId(entities);
+        });
+      }
+    } catch (_) {
+      // Records stay dirty (and journaled) natively; retry later.
+      _pending += pending;
+      rethrow;
+    }
+    native.checkpoint(dirty.generation);
+  }
+}
+
+/// Binary encoding of a [SessionEntity] for the native cache
+///
+/// Avoids a JSON round-trip per ratchet step; the chain key
+/// and skipped-key fields are already JSON strings in the
+/// entity and are stored as-is.
+abstract final class _SessionRecord {
+  static const int _version = 1;
+  static const int _null = 0xFFFFFFFF;
+
+  static Uint8List encode(SessionEntity entity) {
+    final builder = BytesBuilder(copy: false);
+    final header = ByteData(30)
+      ..setUint8(0, _version)
+      ..setUint8(1, entity.status.index)
+      ..setInt64(2, entity.createdAt, Endian.little)
+      ..setInt64(10, entity.lastMessageAt ?? -1, Endian.little)
+      ..setUint32(18, entity.sendingChainLength, Endian.little)
+      ..setUint32(22, entity.receivingChainLength, Endian.little)
+      ..setUint32(26, entity.previousSendingChainLength, Endian.little);
+    builder.add(header.buffer.asUint8List());
+
+    _addString(builder, entity.myOdid);
+    _addString(builder, entity.remoteOdid);
+    _addString(builder, entity.remoteDeviceId);
+    _addBytes(builder, entity.rootKey);
+    _addString(builder, entity.sendingChainKey);
+    _addString(builder, entity.receivingChainKey);
+    _addBytes(builder, entity.myRatchetPrivateKey);
+    _addBytes(builder, entity.myRatchetPublicKey);
+    _addBytes(builder, entity.theirRatchetPublicKey);
+    _addString(builder, entity.skippedKeys);
+    return builder.takeBytes();
+  }
+
+  static SessionEntity decode(String sessionId, Uint8List bytes) {
+    final view = ByteData.sublistView(bytes);
+    if (view.getUint8(0) != _version) {
+      throw const FormatException('Unknown session record version');
+    }
+    final reader = _RecordReader(bytes, view, 30);
+    final lastMessageAt = view.getInt64(10, Endian.little);
+
+    return SessionEntity()
+      ..sessionId = sessionId
+      ..status = SessionStatus.values[view.getUint8(1)]
+      ..createdAt = view.getInt64(2, Endian.little)
+      ..lastMessageAt = lastMessageAt < 0 ? null : lastMessageAt
+      ..sendingChainLength = view.getUint32(18, Endian.little)
+      ..receivingChainLength = view.getUint32(22, Endian.little)
+      ..previousSendingChainLength = view.getUint32(26, Endian.little)
+      ..myOdid = reader.string()!
+      ..remoteOdid = reader.string()!
+      ..remoteDeviceId = reader.string()!
+      ..rootKey = reader.bytes()!
+      ..sendingChainKey = reader.string()
+      ..receivingChainKey = reader.string()
+      ..myRatchetPrivateKey = reader.bytes()
+      ..myRatchetPublicKey = reader.bytes()
+      ..theirRatchetPublicKey = reader.bytes()
+      ..skippedKeys = reader.string()!;
+  }
+
+  static void _addString(BytesBuilder builder, String? value) {
+    _addBytes(builder, value == null ? null : utf8.encode(value));
+  }
+
+  static void _addBytes(BytesBuilder builder, List<int>? value) {
+    final length = ByteData(4)
+      ..setUint32(0, value?.length ?? _null, Endian.little);
+    builder.add(length.buffer.asUint8List());
+    if (value != null) builder.add(value);
+  }
+}
+
+class _RecordReader {
+  _RecordReader(this._bytes, this._view, this._offset);
+
+  final Uint8List _bytes;
+  final ByteData _view;
+  int _offset;
+
+  List<int>? bytes() {
+    final length = _view.getUint32(_offset, Endian.little);
+    _offset += 4;
+    if (length == _SessionRecord._null) return null;
+    final value = Uint8List.fromList(
+      Uint8List.sublistView(_bytes, _offset, _offset + length),
+    );
+    _offset += length;
+    return value;
+  }
+
+  String? string() {
+    final value = bytes();
+    return value == null ? null : utf8.decode(value);
+  }
+}
@@ -6,6 +6,7 @@ import 'package:isar/isar.dart';
 
 import '../entities/session_entity.dart';
 import '../ratchet/double_ratchet.dart';
+import 'session_cache.dart';
 import 'vault.dart';
 
 /// ============================================================
@@ -16,6 +17,9 @@ import 'vault.dart';
 /// • Active sessions
 /// • Session state serialization
 /// • Multi-device session management
+///
+/// Hot sessions are served and updated through [SessionCache]
+/// when it is open; Isar is then written back in batches.
 /// ============================================================
 final class SessionStore {
   SessionStore._();
@@ -35,9 +39,14 @@ final class SessionStore {
 
   /// Get session by ID
   static Future<SessionEntity?> getSession(String sessionId) async {
-    return Vault.read((db) async {
+    final cached = SessionCache.get(sessionId);
+    if (cached != null) return cached;
+
+    final entity = await Vault.read((db) async {
       return db.sessionEntitys.filter().sessionIdEqualTo(sessionId).findFirst();
     });
+    if (entity != null) SessionCache.prime(entity);
+    return entity;
   }
 
   /// Get session for a contact
@@ -54,6 +63,7 @@ final class SessionStore {
   static Future<List<SessionEntity>> getSessionsForContact(
     String theirOdid,
   ) async {
+    await SessionCache.flush();
     return Vault.read((db) async {
       return db.sessionEntitys.filter().remoteOdidEqualTo(theirOdid).findAll();
     });
@@ -73,27 +83,16 @@ final class SessionStore {
       ..myOdid = myOdid
       ..remoteOdid = remoteOdid
       ..remoteDeviceId = remoteDeviceId
-      ..rootKey = state.rootKey.toList()
-      ..sendingChainKey = state.sendingChainKey != null
-          ? jsonEncode(state.sendingChainKey)
-          : null
-      ..receivingChainKey = state.receivingChainKey != null
-          ? jsonEncode(state.receivingChainKey)
-          : null
-      ..myRatchetPrivateKey = myRatchetPrivateKey.toList()
-      ..myRatchetPublicKey = state.myRatchetPublicKey?.toList()
-      ..theirRatchetPublicKey = state.theirRatchetPublicKey?.toList()
-      ..sendingChainLength = state.sendingChainLength
-      ..receivingChainLength = state.receivingChainLength
-      ..previousSendingChainLength = state.previousSendingChainLength
-      ..skippedKeys = jsonEncode(state.skippedKeys)
       ..createdAt = DateTime.now().millisecondsSinceEpoch
-      ..lastMessageAt = DateTime.now().millisecondsSinceEpoch
       ..status = SessionStatus.active;
+    _applyState(
+      entity,
+      state,
+      myRatchetPrivateKey,
+      DateTime.now().millisecondsSinceEpoch,
+    );
 
-    await Vault.write((db) async {
-      await db.sessionEntitys.put(entity);
-    });
+    await _store(entity);
   }
 
   /// Update session after message
@@ -102,31 +101,76 @@ final class SessionStore {
     required RatchetSessionState state,
     required Uint8List myRatchetPrivateKey,
   }) async {
+    final entity = await getSession(sessionId);
+    if (entity == null) return;
+
+    _applyState(
+      entity,
+      state,
+      myRatchetPrivateKey,
+      DateTime.now().millisecondsSinceEpoch,
+    );
+    await _store(entity);
+  }
+
+  /// Get sessions by ID in one read, in the order of [sessionIds]
+  static Future<List<SessionEntity?>> getSessions(
+    List<String> sessionIds,
+  ) async {
+    if (sessionIds.isEmpty) return const [];
+    final sessions = sessionIds.map(SessionCache.get).toList();
+    final misses = [
+      for (var i = 0; i < sessionIds.length; i++)
+        if (sessions[i] == null) sessionIds[i],
+    ];
+    if (misses.isEmpty) return sessions;
+
+    final loaded = await Vault.read((db) async {
+      return db.sessionEntitys.getAllBySessionId(misses);
+    });
+    var next = 0;
+    for (var i = 0; i < sessions.length; i++) {
+      if (sessions[i] != null) continue;
+      final entity = loaded[next++];
+      if (entity != null) SessionCache.prime(entity);
+      sessions[i] = entity;
+    }
+    return sessions;
+  }
+
+  /// Save or update many sessions in a single write transaction
+  ///
+  /// Used after batch encryption so a fan-out to N devices costs one
+  /// durable write instead of N.
+  static Future<void> saveSessions(List<SessionWrite> writes) async {
+    if (writes.isEmpty) return;
+    final now = DateTime.now().millisecondsSinceEpoch;
+
+    if (SessionCache.isOpen) {
+      final existing = await getSessions(
+        writes.map((write) => write.sessionId).toList(),
+      );
+      final uncached = <SessionEntity>[];
+      for (var i = 0; i < writes.length; i++) {
+        final entity = _entityForWrite(writes[i], existing[i], now);
+        if (!SessionCache.put(entity)) uncached.add(entity);
+      }
+      if (uncached.isEmpty) return;
+      await Vault.write((db) async {
+        await db.sessionEntitys.putAllBySessionId(uncached);
+      });
+      return;
+    }
+
     await Vault.write((db) async {
-      final entity = await db.sessionEntitys
-          .filter()
-          .sessionIdEqualTo(sessionId)
-          .findFirst();
-
-      if (entity != null) {
-        entity.rootKey = state.rootKey.toList();
-        entity.sendingChainKey = state.sendingChainKey != null
-            ? jsonEncode(state.sendingChainKey)
-            : null;
-        entity.receivingChainKey = state.receivingChainKey != null
-            ? jsonEncode(state.receivingChainKey)
-            : null;
-        entity.myRatchetPrivateKey = myRatchetPrivateKey.toList();
-        entity.myRatchetPublicKey = state.myRatchetPublicKey?.toList();
-        entity.theirRatchetPublicKey = state.theirRatchetPublicKey?.toList();
-        entity.sendingChainLength = state.sendingChainLength;
-        entity.receivingChainLength = state.receivingChainLength;
-        entity.previousSendingChainLength = state.previousSendingChainLength;
-        entity.skippedKeys = jsonEncode(state.skippedKeys);
-        entity.lastMessageAt = DateTime.now().millisecondsSinceEpoch;
-
-        await db.sessionEntitys.put(entity);
+      final existing = await db.sessionEntitys.getAllBySessionId(
+        writes.map((write) => write.sessionId).toList(),
+      );
+      final entities = <SessionEntity>[];
+      for (var i = 0; i < writes.length; i++) {
+        entities.add(_entityForWrite(writes[i], existing[i], now));
       }
+      await db.sessionEntitys.putAll(entities);
     });
   }
 
@@ -138,6 +182,7 @@ final class SessionStore {
 
   /// Delete session
   static Future<void> deleteSession(String sessionId) async {
+    await SessionCache.remove(sessionId);
     await Vault.write((db) async {
       await db.sessionEntitys.filter().sessionIdEqualTo(sessionId).deleteAll();
     });
@@ -145,6 +190,11 @@ final class SessionStore {
 
   /// Delete all sessions for a contact
   static Future<void> deleteSessionsForContact(String remoteOdid) async {
+    if (SessionCache.isOpen) {
+      for (final session in await getSessionsForContact(remoteOdid)) {
+        await SessionCache.remove(session.sessionId);
+      }
+    }
     await Vault.write((db) async {
       await db.sessionEntitys
           .filter()
@@ -155,6 +205,7 @@ final class SessionStore {
 
   /// Get all active sessions
   static Future<List<SessionEntity>> getActiveSessions() async {
+    await SessionCache.flush();
     return Vault.read((db) async {
       return db.sessionEntitys
           .filter()
@@ -171,6 +222,7 @@ final class SessionStore {
         .subtract(Duration(days: staleDays))
         .millisecondsSinceEpoch;
 
+    await SessionCache.flush();
     return Vault.read((db) async {
       return db.sessionEntitys
           .filter()
@@ -181,26 +233,71 @@ final class SessionStore {
 
   /// Mark session as stale
   static Future<void> markSessionStale(String sessionId) async {
-    await Vault.write((db) async {
-      final entity = await db.sessionEntitys
-          .filter()
-          .sessionIdEqualTo(sessionId)
-          .findFirst();
+    final entity = await getSession(sessionId);
+    if (entity == null) return;
 
-      if (entity != null) {
-        entity.status = SessionStatus.stale;
-        await db.sessionEntitys.put(entity);
-      }
-    });
+    entity.status = SessionStatus.stale;
+    await _store(entity);
   }
 
   /// Get session count
   static Future<int> getCount() async {
+    await SessionCache.flush();
     return Vault.read((db) async {
       return db.sessionEntitys.count();
     });
   }
 
+  /// Write [entity] through the cache, or to Isar when it is closed
+  static Future<void> _store(SessionEntity entity) async {
+    if (SessionCache.put(entity)) return;
+    await Vault.write((db) async {
+      await db.sessionEntitys.putBySessionId(entity);
+    });
+  }
+
+  static SessionEntity _entityForWrite(
+    SessionWrite write,
+    SessionEntity? existing,
+    int now,
+  ) {
+    final entity =
+        existing ??
+        (SessionEntity()
+          ..sessionId = write.sessionId
+          ..myOdid = write.myOdid
+          ..remoteOdid = write.remoteOdid
+          ..remoteDeviceId = write.remoteDeviceId
+          ..createdAt = now
+          ..status = SessionStatus.active);
+    _applyState(entity, write.state, write.myRatchetPrivateKey, now);
+    return entity;
+  }
+
+  static void _applyState(
+    SessionEntity entity,
+    RatchetSessionState state,
+    Uint8List myRatchetPrivateKey,
+    int now,
+  ) {
+    entity
+      ..rootKey = state.rootKey.toList()
+      ..sendingChainKey = state.sendingChainKey != null
+          ? jsonEncode(state.sendingChainKey)
+          : null
+      ..receivingChainKey = state.receivingChainKey != null
+          ? jsonEncode(state.receivingChainKey)
+          : null
+      ..myRatchetPrivateKey = myRatchetPrivateKey.toList()
+      ..myRatchetPublicKey = state.myRatchetPublicKey?.toList()
+      ..theirRatchetPublicKey = state.theirRatchetPublicKey?.toList()
+      ..sendingChainLength = state.sendingChainLength
+      ..receivingChainLength = state.receivingChainLength
+      ..previousSendingChainLength = state.previousSendingChainLength
+      ..skippedKeys = jsonEncode(state.skippedKeys)
+      ..lastMessageAt = now;
+  }
+
   /// Convert entity to RatchetSessionState
   static RatchetSessionState entityToState(SessionEntity entity) {
     return RatchetSessionState(
@@ -225,3 +322,22 @@ final class SessionStore {
     );
   }
 }
+
+/// Session state to persist with [SessionStore.saveSessions]
+class SessionWrite {
+  final String sessionId;
+  final String myOdid;
+  final String remoteOdid;
+  final String remoteDeviceId;
+  final RatchetSessionState state;
+  final Uint8List myRatchetPrivateKey;
+
+  const SessionWrite({
+    required this.sessionId,
+    required this.myOdid,
+    required this.remoteOdid,
+    required this.remoteDeviceId,
+    required this.state,
+    required this.myRatchetPrivateKey,
+  });
+}
@@ -24,6 +24,9 @@ final class Vault {
 
   static bool get isInitialized => _initialized;
 
+  /// Directory holding the vault files (null until initialized)
+  static String? get directory => _dbPath;
+
   static Isar get db {
     if (!_initialized || _db == null) {
       throw StateError(
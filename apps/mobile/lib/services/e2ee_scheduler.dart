@@ -12,23 +12,38 @@ class E2eeKeyRefreshScheduler {
   final E2eeService _e2ee;
   final Duration _interval;
   Timer? _timer;
+  StreamSubscription<void>? _preKeysLow;
+  Future<void>? _inFlight;
 
   bool get isRunning => _timer != null;
 
   Future<void> start() async {
     if (_timer != null) return;
-    await _runOnce();
     _timer = Timer.periodic(_interval, (_) {
       _runOnce();
     });
+    // A burst of new contacts drains one-time pre-keys long before the
+    // next periodic run; replenish as soon as the supply runs low.
+    _preKeysLow = E2eeService.preKeysLow.listen((_) => refreshNow());
+    await _runOnce();
   }
 
   void stop() {
     _timer?.cancel();
     _timer = null;
+    _preKeysLow?.cancel();
+    _preKeysLow = null;
+  }
+
+  /// Replenish now. Calls made while a refresh is running join it
+  /// instead of starting another batch.
+  Future<void> refreshNow() => _runOnce();
+
+  Future<void> _runOnce() {
+    return _inFlight ??= _refresh().whenComplete(() => _inFlight = null);
   }
 
-  Future<void> _runOnce() async {
+  Future<void> _refresh() async {
     try {
       await _e2ee.refreshKeysIfNeeded();
     } catch (_) {
@@ -1,4 +1,6 @@
+import 'dart:async';
 import 'dart:convert';
+import 'dart:developer' as developer;
 import 'dart:io';
 import 'dart:typed_data';
 
@@ -7,10 +9,13 @@ import 'package:sodium_libs/sodium_libs.dart';
 import '../core/device/device_id.dart';
 import '../core/network/api_client.dart';
 import '../core/storage/secure_store.dart';
+import '../security/bridge/native_group_distribution.dart';
+import '../security/bridge/native_prekeys.dart';
 import '../security/bridge/sodium_loader.dart';
 import '../security/crypto/key_generation.dart';
 import '../security/crypto/x3dh.dart';
 import '../security/entities/prekey_entity.dart';
+import '../security/entities/session_entity.dart';
 import '../security/ratchet/double_ratchet.dart';
 import '../security/ratchet/message_keys.dart';
 import '../security/ratchet/skipped_keys.dart';
@@ -23,6 +28,9 @@ import '../security/storage/signed_prekey_store.dart';
 class E2eeService {
   static const String envelopePrefix = 'e2ee.v1:';
 
+  /// Parallel device-list / pre-key bundle requests during fan-out
+  static const int _fanOutConcurrency = 8;
+
   E2eeService({SecureStore? store})
     : _store = store ?? SecureStore(),
       _deviceIdStore = DeviceIdStore(store ?? SecureStore()),
@@ -32,6 +40,16 @@ class E2eeService {
   final DeviceIdStore _deviceIdStore;
   final ApiClient _client;
 
+  /// Last native batch whose upload JSON has not been sent yet
+  NativePreKeyBatch? _pendingNativeBatch;
+
+  static final StreamController<void> _preKeysLow =
+      StreamController<void>.broadcast();
+
+  /// Fires when an inbound session consumed a one-time pre-key and
+  /// the local supply fell below [PreKeyStore.replenishThreshold]
+  static Stream<void> get preKeysLow => _preKeysLow.stream;
+
   static bool isEncrypted(String body) {
     return body.startsWith(envelopePrefix);
   }
@@ -46,6 +64,7 @@ class E2eeService {
     final localIdentity = await _ensureLocalIdentity(userId, deviceId);
     final xIdentity = await _ensureLocalXIdentity();
     try {
+      await _replenishWithNativeBatch(localIdentity.privateKey);
       final signedPreKey = await _ensureSignedPreKey(localIdentity.privateKey);
       final pendingPreKeys = await _ensurePreKeys();
       await _registerDevice(
@@ -76,6 +95,7 @@ class E2eeService {
           pendingPreKeys.isNotEmpty || await PreKeyStore.needsReplenishment();
       if (!needsRotation && !needsPreKeys) return false;
 
+      await _replenishWithNativeBatch(localIdentity.privateKey);
       final signedPreKey = await _ensureSignedPreKey(localIdentity.privateKey);
       final refreshedPreKeys = await _ensurePreKeys();
       await _registerDevice(
@@ -125,20 +145,33 @@ class E2eeService {
       );
       if (targets.isEmpty) return null;
 
-      final recipients = <Map<String, dynamic>>[];
-      for (final target in targets) {
-        final encrypted = await _encryptForDevice(
-          myUserId: userId,
-          myDeviceId: deviceId,
-          myRegistrationId: localIdentity.registrationId,
-          myIdentityKeyEd: localIdentity.publicKey,
-          myIdentityKeyX: xIdentity.publicKey,
-          myIdentityPrivateKeyX: xIdentity.privateKey,
-          target: target,
-          plaintext: plaintext,
-        );
-        if (encrypted != null) {
-          recipients.add(encrypted);
+      var recipients = targets.length > 1
+          ? await _encryptForDevicesBatched(
+              myUserId: userId,
+              myRegistrationId: localIdentity.registrationId,
+              myIdentityKeyEd: localIdentity.publicKey,
+              myIdentityKeyX: xIdentity.publicKey,
+              myIdentityPrivateKeyX: xIdentity.privateKey,
+              targets: targets,
+              plaintext: plaintext,
+            )
+          : null;
+      if (recipients == null) {
+        recipients = <Map<String, dynamic>>[];
+        for (final target in targets) {
+          final encrypted = await _encryptForDevice(
+            myUserId: userId,
+            myDeviceId: deviceId,
+            myRegistrationId: localIdentity.registrationId,
+            myIdentityKeyEd: localIdentity.publicKey,
+            myIdentityKeyX: xIdentity.publicKey,
+            myIdentityPrivateKeyX: xIdentity.privateKey,
+            target: target,
+            plaintext: plaintext,
+          );
+          if (encrypted != null) {
+            recipients.add(encrypted);
+          }
         }
       }
 
@@ -323,6 +356,43 @@ class E2eeService {
     );
   }
 
+  /// Rotate the signed pre-key and replenish one-time pre-keys in one
+  /// native batch when the kernel is bundled. Leaves nothing to do for
+  /// [_ensureSignedPreKey] / [_ensurePreKeys], which stay as the fallback.
+  Future<void> _replenishWithNativeBatch(SecureKey identityPrivateKey) async {
+    if (!NativePreKeys.isAvailable) return;
+    final needsRotation = await SignedPreKeyStore.needsRotation();
+    final needsPreKeys = await PreKeyStore.needsReplenishment();
+    if (!needsRotation && !needsPreKeys) return;
+
+    final identitySecret = needsRotation
+        ? identityPrivateKey.extractBytes()
+        : null;
+    try {
+      final batch = await NativePreKeys.generate(
+        startId: await PreKeyStore.getNextKeyId(),
+        count: needsPreKeys ? PreKeyStore.defaultBatchSize : 0,
+        signedKeyId: needsRotation
+            ? await SignedPreKeyStore.getNextKeyId()
+            : null,
+        identitySecretKey: identitySecret,
+      );
+      if (batch == null) return;
+
+      await PreKeyStore.saveReplenishment(
+        preKeys: batch.preKeys,
+        signedPreKey: batch.signedPreKey,
+      );
+      // Per-phase timings of the native batch, visible in DevTools.
+      developer.log('${batch.timings}', name: 'prava.e2ee.prekeys');
+      _pendingNativeBatch = batch.preKeys.isEmpty ? null : batch;
+    } catch (_) {
+      // fall back to Dart key generation
+    } finally {
+      identitySecret?.fillRange(0, identitySecret.length, 0);
+    }
+  }
+
   Future<List<PreKeyEntity>> _ensurePreKeys() async {
     if (await PreKeyStore.needsReplenishment()) {
       final startId = await PreKeyStore.getNextKeyId();
@@ -369,18 +439,19 @@ class E2eeService {
         'publicKey': base64Encode(signedPreKey.publicKey),
         'signature': base64Encode(signedPreKey.signature),
       },
-      if (registerKeys.isNotEmpty)
-        'oneTimePreKeys': registerKeys
-            .map(
-              (key) => {
-                'keyId': key.keyId,
-                'publicKey': base64Encode(Uint8List.fromList(key.publicKey)),
-              },
-            )
-            .toList(),
     };
 
-    await _client.post('/crypto/devices/register', auth: true, body: body);
+    await _client.postEncoded(
+      '/crypto/devices/register',
+      auth: true,
+      body: registerKeys.isEmpty
+          ? jsonEncode(body)
+          : _appendJsonField(
+              jsonEncode(body),
+              'oneTimePreKeys',
+              _encodePreKeyList(registerKeys),
+            ),
+    );
 
     if (registerKeys.isNotEmpty) {
       await PreKeyStore.markUploaded(
@@ -399,24 +470,52 @@ class E2eeService {
     required List<PreKeyEntity> preKeys,
   }) async {
     if (preKeys.isEmpty) return;
-    await _client.post(
+    await _client.postEncoded(
       '/crypto/prekeys',
       auth: true,
-      body: {
-        'deviceId': deviceId,
-        'preKeys': preKeys
-            .map(
-              (key) => {
-                'keyId': key.keyId,
-                'publicKey': base64Encode(Uint8List.fromList(key.publicKey)),
-              },
-            )
-            .toList(),
-      },
+      body: _appendJsonField(
+        jsonEncode({'deviceId': deviceId}),
+        'preKeys',
+        _encodePreKeyList(preKeys),
+      ),
     );
     await PreKeyStore.markUploaded(preKeys.map((key) => key.keyId).toList());
   }
 
+  /// Encode `{keyId, publicKey}` entries, reusing the array serialized by
+  /// the native batch when it covers exactly these keys.
+  String _encodePreKeyList(List<PreKeyEntity> preKeys) {
+    final batch = _pendingNativeBatch;
+    if (batch != null) {
+      final ids = batch.keyIds;
+      var matches = ids.length == preKeys.length;
+      for (var i = 0; matches && i < ids.length; i++) {
+        matches = ids[i] == preKeys[i].keyId;
+      }
+      if (matches) {
+        _pendingNativeBatch = null;
+        return batch.uploadJson;
+      }
+    }
+
+    return jsonEncode(
+      preKeys
+          .map(
+            (key) => {
+              'keyId': key.keyId,
+              'publicKey': base64Encode(Uint8List.fromList(key.publicKey)),
+            },
+          )
+          .toList(),
+    );
+  }
+
+  /// Append a pre-encoded JSON value to an encoded, non-empty object
+  static String _appendJsonField(String object, String key, String value) {
+    return '${object.substring(0, object.length - 1)},'
+        '${jsonEncode(key)}:$value}';
+  }
+
   Future<List<_RemoteDevice>> _listDevices(String userId) async {
     final data = await _client.get('/crypto/devices/$userId', auth: true);
     if (data is! List) return [];
@@ -459,10 +558,19 @@ class E2eeService {
     final targets = <_RemoteDevice>[];
     final seen = <String>{};
 
-    for (final userId in userIds) {
-      final trimmed = userId.trim();
-      if (trimmed.isEmpty) continue;
-      final devices = await _listDevices(trimmed);
+    final trimmedIds = userIds
+        .map((userId) => userId.trim())
+        .where((userId) => userId.isNotEmpty)
+        .toList();
+    final deviceLists = List<List<_RemoteDevice>>.filled(
+      trimmedIds.length,
+      const [],
+    );
+    await _forEachConcurrently(trimmedIds.length, (i) async {
+      deviceLists[i] = await _listDevices(trimmedIds[i]);
+    });
+
+    for (final devices in deviceLists) {
       for (final device in devices) {
         final key = '${device.userId}:${device.deviceId}';
         if (seen.add(key)) {
@@ -500,57 +608,18 @@ class E2eeService {
       target.userId,
       target.deviceId,
     );
-    final existing = await SessionStore.getSession(sessionId);
-    DoubleRatchet ratchet;
-    Map<String, dynamic>? preKeyPayload;
-
-    if (existing != null && existing.myRatchetPrivateKey != null) {
-      final state = SessionStore.entityToState(existing);
-      final sodium = await SodiumLoader.sodium;
-      final privateKey = sodium.secureCopy(
-        Uint8List.fromList(existing.myRatchetPrivateKey!),
-      );
-      ratchet = await DoubleRatchet.importState(
-        state: state,
-        myRatchetPrivateKey: privateKey,
-      );
-    } else {
-      final bundle = await _fetchPreKeyBundle(
-        userId: target.userId,
-        deviceId: target.deviceId,
-      );
-      if (bundle == null) return null;
-
-      final initiator = await X3DH.initiateSession(
-        myIdentityPublicKeyX25519: myIdentityKeyX,
-        myIdentityPrivateKeyX25519: myIdentityPrivateKeyX,
-        theirIdentityPublicKeyX25519: bundle.identityKeyX,
-        theirSignedPreKeyPublic: bundle.signedPreKeyPublic,
-        theirSignedPreKeySignature: bundle.signedPreKeySignature,
-        theirIdentityPublicKeyEd25519: bundle.identityKeyEd,
-        theirOneTimePreKeyPublic: bundle.oneTimePreKeyPublic,
-        theirOneTimePreKeyId: bundle.oneTimePreKeyId,
-      );
-
-      ratchet = await DoubleRatchet.initializeAsInitiator(
-        sharedSecret: initiator.sharedSecret,
-        theirRatchetPublicKey: bundle.signedPreKeyPublic,
-        sessionId: sessionId,
-      );
-      final ephemeralKey = initiator.ephemeralPublicKey;
-      final usedOneTimePreKeyId = initiator.usedOneTimePreKeyId;
-      initiator.dispose();
-
-      preKeyPayload = {
-        'senderIdentityKeyEd': base64Encode(myIdentityKeyEd),
-        'senderIdentityKeyX': base64Encode(myIdentityKeyX),
-        'senderEphemeralKey': base64Encode(ephemeralKey),
-        'senderRegistrationId': myRegistrationId,
-        'signedPreKeyId': bundle.signedPreKeyId,
-        if (usedOneTimePreKeyId != null) 'oneTimePreKeyId': usedOneTimePreKeyId,
-      };
-    }
+    final session = await _openSendingSession(
+      sessionId: sessionId,
+      existing: await SessionStore.getSession(sessionId),
+      myRegistrationId: myRegistrationId,
+      myIdentityKeyEd: myIdentityKeyEd,
+      myIdentityKeyX: myIdentityKeyX,
+      myIdentityPrivateKeyX: myIdentityPrivateKeyX,
+      target: target,
+    );
+    if (session == null) return null;
 
+    final ratchet = session.ratchet;
     try {
       final message = await ratchet.encrypt(
         Uint8List.fromList(utf8.encode(plaintext)),
@@ -560,7 +629,7 @@ class E2eeService {
       final state = ratchet.exportState();
       final myRatchetPrivateKey = ratchet.exportMyRatchetPrivateKey();
 
-      if (existing != null && existing.myRatchetPrivateKey != null) {
+      if (session.isExisting) {
         await SessionStore.updateSession(
           sessionId: sessionId,
           state: state,
@@ -577,17 +646,225 @@ class E2eeService {
         );
       }
 
-      return {
-        'userId': target.userId,
-        'deviceId': target.deviceId,
-        'ratchet': encrypted,
-        if (preKeyPayload != null) 'preKey': preKeyPayload,
-      };
+      return session.toRecipient(encrypted);
     } finally {
       ratchet.dispose();
     }
   }
 
+  /// Encrypt one plaintext for many devices with the native batch kernel.
+  ///
+  /// Sessions are loaded in one read and opened with bounded concurrency,
+  /// every sending chain is advanced in Dart, the payload is sealed for all
+  /// devices in parallel natively, and the updated sessions are written back
+  /// in a single transaction. Returns null when the kernel is unavailable or
+  /// the message is outside its limits, before any session is opened or
+  /// ratchet advanced, so the caller can fall back to [_encryptForDevice].
+  ///
+  /// Once sessions are being opened the batch does not fail as a whole:
+  /// a session newly established over X3DH has already used up a one-time
+  /// pre-key on the server. A device whose session cannot be opened is
+  /// skipped like one without a bundle, and if the native seal fails the
+  /// advanced steps are sealed in Dart instead.
+  Future<List<Map<String, dynamic>>?> _encryptForDevicesBatched({
+    required String myUserId,
+    required int myRegistrationId,
+    required Uint8List myIdentityKeyEd,
+    required Uint8List myIdentityKeyX,
+    required SecureKey myIdentityPrivateKeyX,
+    required List<_RemoteDevice> targets,
+    required String plaintext,
+  }) async {
+    final payload = Uint8List.fromList(utf8.encode(plaintext));
+    if (!NativeGroupDistribution.canSeal(
+      plaintextLength: payload.length,
+      deviceCount: targets.length,
+    )) {
+      return null;
+    }
+
+    final sessionIds = targets
+        .map(
+          (target) => SessionStore.makeSessionId(
+            myUserId,
+            target.userId,
+            target.deviceId,
+          ),
+        )
+        .toList();
+    final existing = await SessionStore.getSessions(sessionIds);
+
+    final sessions = List<_SendingSession?>.filled(targets.length, null);
+    final steps = <RatchetSendStep>[];
+    try {
+      await _forEachConcurrently(targets.length, (i) async {
+        try {
+          sessions[i] = await _openSendingSession(
+            sessionId: sessionIds[i],
+            existing: existing[i],
+            myRegistrationId: myRegistrationId,
+            myIdentityKeyEd: myIdentityKeyEd,
+            myIdentityKeyX: myIdentityKeyX,
+            myIdentityPrivateKeyX: myIdentityPrivateKeyX,
+            target: targets[i],
+          );
+        } catch (_) {
+          // Bundle fetch or X3DH failed for this device only.
+        }
+      });
+
+      final opened = sessions.whereType<_SendingSession>().toList();
+      if (opened.isEmpty) return const [];
+      for (final session in opened) {
+        steps.add(await session.ratchet.advanceSending());
+      }
+
+      final envelopes =
+          NativeGroupDistribution.seal(plaintext: payload, steps: steps)
+              ?.envelopes ??
+          await _sealSteps(payload, steps);
+
+      await SessionStore.saveSessions([
+        for (final session in opened)
+          SessionWrite(
+            sessionId: session.sessionId,
+            myOdid: myUserId,
+            remoteOdid: session.target.userId,
+            remoteDeviceId: session.target.deviceId,
+            state: session.ratchet.exportState(),
+            myRatchetPrivateKey: session.ratchet.exportMyRatchetPrivateKey(),
+          ),
+      ]);
+
+      return [
+        for (var i = 0; i < opened.length; i++)
+          opened[i].toRecipient(envelopes[i]),
+      ];
+    } finally {
+      for (final step in steps) {
+        step.disposeMessageKey();
+      }
+      for (final session in sessions) {
+        session?.ratchet.dispose();
+      }
+    }
+  }
+
+  /// Dart equivalent of [NativeGroupDistribution.seal] for steps that are
+  /// already advanced: the same framing as [DoubleRatchet.encrypt]
+  static Future<List<String>> _sealSteps(
+    Uint8List payload,
+    List<RatchetSendStep> steps,
+  ) async {
+    final envelopes = <String>[];
+    for (final step in steps) {
+      final encrypted = await MessageKeys.encrypt(
+        plaintext: payload,
+        messageKey: step.messageKey,
+      );
+      final message = RatchetMessage(
+        ciphertext: encrypted.ciphertext,
+        nonce: encrypted.nonce,
+        ratchetPublicKey: step.ratchetPublicKey,
+        messageNumber: step.messageNumber,
+        previousChainLength: step.previousChainLength,
+      );
+      envelopes.add(base64Encode(message.toBytes()));
+    }
+    return envelopes;
+  }
+
+  /// Load or establish (X3DH) the sending ratchet for one device
+  Future<_SendingSession?> _openSendingSession({
+    required String sessionId,
+    required SessionEntity? existing,
+    required int myRegistrationId,
+    required Uint8List myIdentityKeyEd,
+    required Uint8List myIdentityKeyX,
+    required SecureKey myIdentityPrivateKeyX,
+    required _RemoteDevice target,
+  }) async {
+    if (existing != null && existing.myRatchetPrivateKey != null) {
+      final state = SessionStore.entityToState(existing);
+      final sodium = await SodiumLoader.sodium;
+      final privateKey = sodium.secureCopy(
+        Uint8List.fromList(existing.myRatchetPrivateKey!),
+      );
+      final ratchet = await DoubleRatchet.importState(
+        state: state,
+        myRatchetPrivateKey: privateKey,
+      );
+      return _SendingSession(
+        sessionId: sessionId,
+        target: target,
+        ratchet: ratchet,
+        isExisting: true,
+      );
+    }
+
+    final bundle = await _fetchPreKeyBundle(
+      userId: target.userId,
+      deviceId: target.deviceId,
+    );
+    if (bundle == null) return null;
+
+    final initiator = await X3DH.initiateSession(
+      myIdentityPublicKeyX25519: myIdentityKeyX,
+      myIdentityPrivateKeyX25519: myIdentityPrivateKeyX,
+      theirIdentityPublicKeyX25519: bundle.identityKeyX,
+      theirSignedPreKeyPublic: bundle.signedPreKeyPublic,
+      theirSignedPreKeySignature: bundle.signedPreKeySignature,
+      theirIdentityPublicKeyEd25519: bundle.identityKeyEd,
+      theirOneTimePreKeyPublic: bundle.oneTimePreKeyPublic,
+      theirOneTimePreKeyId: bundle.oneTimePreKeyId,
+    );
+
+    final ratchet = await DoubleRatchet.initializeAsInitiator(
+      sharedSecret: initiator.sharedSecret,
+      theirRatchetPublicKey: bundle.signedPreKeyPublic,
+      sessionId: sessionId,
+    );
+    final ephemeralKey = initiator.ephemeralPublicKey;
+    final usedOneTimePreKeyId = initiator.usedOneTimePreKeyId;
+    initiator.dispose();
+
+    return _SendingSession(
+      sessionId: sessionId,
+      target: target,
+      ratchet: ratchet,
+      isExisting: false,
+      preKeyPayload: {
+        'senderIdentityKeyEd': base64Encode(myIdentityKeyEd),
+        'senderIdentityKeyX': base64Encode(myIdentityKeyX),
+        'senderEphemeralKey': base64Encode(ephemeralKey),
+        'senderRegistrationId': myRegistrationId,
+        'signedPreKeyId': bundle.signedPreKeyId,
+        if (usedOneTimePreKeyId != null) 'oneTimePreKeyId': usedOneTimePreKeyId,
+      },
+    );
+  }
+
+  /// Run [action] for indices 0..count-1, at most [_fanOutConcurrency] at
+  /// a time (bounds parallel bundle fetches against the API).
+  static Future<void> _forEachConcurrently(
+    int count,
+    Future<void> Function(int index) action,
+  ) async {
+    var next = 0;
+    Future<void> worker() async {
+      while (next < count) {
+        await action(next++);
+      }
+    }
+
+    await Future.wait(
+      List.generate(
+        count < _fanOutConcurrency ? count : _fanOutConcurrency,
+        (_) => worker(),
+      ),
+    );
+  }
+
   Future<_PreKeyBundle?> _fetchPreKeyBundle({
     required String userId,
     required String deviceId,
@@ -686,6 +963,7 @@ class E2eeService {
       final oneTimeBytes = await PreKeyStore.consumePreKey(oneTimeId);
       if (oneTimeBytes != null) {
         myOneTimePreKeyPrivate = sodium.secureCopy(oneTimeBytes);
+        unawaited(_reportPreKeysIfLow());
       }
     }
 
@@ -738,6 +1016,14 @@ class E2eeService {
     }
   }
 
+  Future<void> _reportPreKeysIfLow() async {
+    try {
+      if (await PreKeyStore.needsReplenishment()) _preKeysLow.add(null);
+    } catch (_) {
+      // the periodic refresh still covers it
+    }
+  }
+
   Future<String?> _decryptWithSession({
     required String sessionId,
     required RatchetMessage message,
@@ -939,6 +1225,29 @@ class _SignedPreKeyBundle {
   final Uint8List signature;
 }
 
+class _SendingSession {
+  _SendingSession({
+    required this.sessionId,
+    required this.target,
+    required this.ratchet,
+    required this.isExisting,
+    this.preKeyPayload,
+  });
+
+  final String sessionId;
+  final _RemoteDevice target;
+  final DoubleRatchet ratchet;
+  final bool isExisting;
+  final Map<String, dynamic>? preKeyPayload;
+
+  Map<String, dynamic> toRecipient(String encrypted) => {
+    'userId': target.userId,
+    'deviceId': target.deviceId,
+    'ratchet': encrypted,
+    if (preKeyPayload != null) 'preKey': preKeyPayload,
+  };
+}
+
 class _RemoteDevice {
   _RemoteDevice({required this.userId, required this.deviceId});
 
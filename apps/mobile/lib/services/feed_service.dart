@@ -1,5 +1,11 @@
+import 'dart:async';
+import 'dart:convert';
+
+import 'package:http/http.dart' as http;
+
 import '../core/network/api_client.dart';
 import '../core/network/api_exception.dart';
+import '../core/storage/feed_cache.dart';
 import '../core/storage/secure_store.dart';
 
 class FeedAuthor {
@@ -406,11 +412,19 @@ class FeedComment {
 }
 
 class FeedService {
-  FeedService({SecureStore? store})
-    : _client = ApiClient(store ?? SecureStore());
+  FeedService({SecureStore? store}) : this._(store ?? SecureStore());
+
+  FeedService._(SecureStore store)
+    : _store = store,
+      _client = ApiClient(store);
 
+  final SecureStore _store;
   final ApiClient _client;
 
+  /// Avatars fetched into the offline cache per stored page
+  static const int _thumbnailsPerPage = 16;
+  static const int _maxThumbnailBytes = 128 * 1024;
+
   Future<List<FeedPost>> listFeed({
     DateTime? before,
     int limit = 20,
@@ -467,12 +481,7 @@ class FeedService {
       query['scope'] = scope.trim();
     }
 
-    final path = switch (normalizedMode) {
-      'topics' => '/feed/topic/${Uri.encodeComponent((topic ?? '').trim())}',
-      'custom' =>
-        '/feed/custom/${Uri.encodeComponent((customFeedId ?? '').trim())}',
-      _ => '/feed/$normalizedMode',
-    };
+    final path = _feedPath(normalizedMode, topic, customFeedId);
 
     final data = await _client.get(path, auth: true, query: query);
     if (data is! Map<String, dynamic>) {
@@ -483,6 +492,51 @@ class FeedService {
       };
     }
 
+    final page = _parseFeedPage(data);
+    if (cursor == null && before == null) {
+      unawaited(_storeFirstPage(path, lens, scope, data, page));
+    }
+    return page;
+  }
+
+  /// First page of a feed from the offline cache, in the shape returned by
+  /// [listFeedPage], or null when nothing is cached for this user.
+  ///
+  /// Meant for the first frame only; follow with [listFeedPage].
+  Future<Map<String, dynamic>?> cachedFeedPage({
+    String mode = 'for-you',
+    String? lens,
+    String? topic,
+    String? customFeedId,
+    String? scope,
+  }) async {
+    final cache = FeedCache.instance;
+    if (!await cache.open()) return null;
+    final userId = await _store.getUserId();
+    if (userId == null || userId.isEmpty) return null;
+
+    final path = _feedPath(_normalizeFeedMode(mode), topic, customFeedId);
+    final bytes = cache.page(_feedCacheKey(userId, path, lens, scope));
+    if (bytes == null) return null;
+    try {
+      final data = jsonDecode(utf8.decode(bytes));
+      if (data is! Map<String, dynamic>) return null;
+      return _parseFeedPage(data);
+    } on FormatException {
+      return null;
+    }
+  }
+
+  String _feedPath(String normalizedMode, String? topic, String? customFeedId) {
+    return switch (normalizedMode) {
+      'topics' => '/feed/topic/${Uri.encodeComponent((topic ?? '').trim())}',
+      'custom' =>
+        '/feed/custom/${Uri.encodeComponent((customFeedId ?? '').trim())}',
+      _ => '/feed/$normalizedMode',
+    };
+  }
+
+  Map<String, dynamic> _parseFeedPage(Map<String, dynamic> data) {
     final items = (data['items'] as List<dynamic>? ?? [])
         .whereType<Map<String, dynamic>>()
         .map(FeedPost.fromJson)
@@ -496,6 +550,58 @@ class FeedService {
     };
   }
 
+  String _feedCacheKey(
+    String userId,
+    String path,
+    String? lens,
+    String? scope,
+  ) {
+    return '$userId|$path|${lens?.trim() ?? ''}|${scope?.trim() ?? ''}';
+  }
+
+  /// Keeps the ranked first page and its author avatars for the next cold
+  /// start. Best effort: failures only cost the offline copy.
+  Future<void> _storeFirstPage(
+    String path,
+    String? lens,
+    String? scope,
+    Map<String, dynamic> data,
+    Map<String, dynamic> page,
+  ) async {
+    try {
+      final cache = FeedCache.instance;
+      if (!await cache.open()) return;
+      final userId = await _store.getUserId();
+      if (userId == null || userId.isEmpty) return;
+
+      cache.putPage(
+        _feedCacheKey(userId, path, lens, scope),
+        utf8.encode(jsonEncode(data)),
+      );
+
+      final avatars = <String>{
+        for (final post in page['items'] as List<FeedPost>)
+          if (post.author.avatarUrl.trim().isNotEmpty)
+            post.author.avatarUrl.trim(),
+      }.where((url) => cache.thumbnail(url) == null);
+      await Future.wait(
+        avatars.take(_thumbnailsPerPage).map((url) async {
+          final response = await http
+              .get(Uri.parse(url))
+              .timeout(const Duration(seconds: 10));
+          if (response.statusCode == 200 &&
+              response.bodyBytes.length <= _maxThumbnailBytes) {
+            cache.putThumbnail(url, response.bodyBytes);
+          }
+        }).map((fetch) => fetch.catchError((Object _) {})),
+      );
+
+      await cache.commit();
+    } catch (_) {
+      // Offline cache is optional.
+    }
+  }
+
   String _normalizeFeedMode(String mode) {
     switch (mode) {
       case 'following':
@@ -142,6 +142,9 @@ class GroupE2eeService {
     );
   }
 
+  /// Encrypt the sender-key distribution for every member device. With the
+  /// native library bundled, all pairwise envelopes are sealed in parallel
+  /// in one batch (see [E2eeService.encryptBodyForUsers]).
   Future<String?> buildDistributionEnvelopeForKey({
     required SenderKeyState senderKey,
     required List<String> memberUserIds,
@@ -0,0 +1,233 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+/// Content address of a local media file, split into upload chunks.
+///
+/// Backed by linux/native/media/media_manifest.cc: the file is memory-mapped
+/// and its chunks are hashed in parallel (BLAKE2b) off the UI isolate. The
+/// root [contentHash] lets the backend recognize media it already has, and
+/// [chunk] returns views straight into the mapping so chunks are sent without
+/// reading the file into the Dart heap.
+///
+/// Only available where libprava_media is bundled (Linux); [build] returns
+/// null elsewhere and callers fall back to a single-request upload.
+class MediaManifest {
+  MediaManifest._(this._bindings, this._handle)
+    : size = _bindings.size(_handle),
+      chunkCount = _bindings.chunkCount(_handle),
+      contentHash = _hex(_bindings.root(_handle).asTypedList(_digestSize)),
+      chunkHashes = _chunkHashes(_bindings, _handle),
+      timings = _timings(_bindings, _handle);
+
+  /// Must stay within the backend's accepted range (256 KiB - 8 MiB), and
+  /// fixed: the content hash depends on it.
+  static const int defaultChunkSize = 4 * 1024 * 1024;
+  static const int _digestSize = 32;
+
+  final _MediaManifestBindings _bindings;
+  Pointer<Void> _handle;
+
+  final int size;
+  final int chunkCount;
+  final String contentHash;
+  final List<String> chunkHashes;
+  final MediaManifestTimings timings;
+
+  int get chunkSize => defaultChunkSize;
+
+  /// Map and hash the file at [path]; null if the native library is missing
+  /// or the file cannot be read.
+  static Future<MediaManifest?> build(String path) async {
+    final bindings = _MediaManifestBindings.load();
+    if (bindings == null) return null;
+
+    final address = await Isolate.run(() {
+      final bindings = _MediaManifestBindings.load();
+      if (bindings == null) return 0;
+      final nativePath = path.toNativeUtf8(allocator: calloc);
+      try {
+        return bindings.build(nativePath, defaultChunkSize).address;
+      } finally {
+        calloc.free(nativePath);
+      }
+    });
+    if (address == 0) return null;
+    return MediaManifest._(bindings, Pointer<Void>.fromAddress(address));
+  }
+
+  bool get isOpen => _handle != nullptr;
+
+  /// Bytes of chunk [index] as a view into the mapped file.
+  ///
+  /// Valid until [close]; do not keep it past the upload.
+  Uint8List chunk(int index) {
+    if (!isOpen) throw StateError('MediaManifest is closed');
+    final length = calloc<Uint32>();
+    try {
+      final data = _bindings.chunk(_handle, index, length);
+      if (data == nullptr) throw RangeError.index(index, this, 'index');
+      return data.asTypedList(length.value);
+    } finally {
+      calloc.free(length);
+    }
+  }
+
+  int chunkLength(int index) {
+    final remaining = size - index * chunkSize;
+    return remaining < chunkSize ? remaining : chunkSize;
+  }
+
+  /// Unmap the file; chunk views become invalid.
+  void close() {
+    if (!isOpen) return;
+    _bindings.close(_handle);
+    _handle = nullptr;
+  }
+
+  static List<String> _chunkHashes(
+    _MediaManifestBindings bindings,
+    Pointer<Void> handle,
+  ) {
+    final count = bindings.chunkCount(handle);
+    final digests = bindings
+        .digests(handle)
+        .asTypedList(count * _digestSize);
+    return List<String>.generate(
+      count,
+      (i) => _hex(
+        Uint8List.sublistView(digests, i * _digestSize, (i + 1) * _digestSize),
+      ),
+      growable: false,
+    );
+  }
+
+  static MediaManifestTimings _timings(
+    _MediaManifestBindings bindings,
+    Pointer<Void> handle,
+  ) {
+    final out = calloc<_ManifestTimings>();
+    try {
+      bindings.timings(handle, out);
+      final t = out.ref;
+      return MediaManifestTimings(
+        map: Duration(microseconds: t.mapNs ~/ 1000),
+        hash: Duration(microseconds: t.hashNs ~/ 1000),
+        total: Duration(microseconds: t.totalNs ~/ 1000),
+        threads: t.threads,
+      );
+    } finally {
+      calloc.free(out);
+    }
+  }
+
+  static String _hex(Uint8List bytes) {
+    final buffer = StringBuffer();
+    for (final byte in bytes) {
+      buffer.write(byte.toRadixString(16).padLeft(2, '0'));
+    }
+    return buffer.toString();
+  }
+}
+
+/// Where the time went while building a [MediaManifest].
+class MediaManifestTimings {
+  const MediaManifestTimings({
+    required this.map,
+    required this.hash,
+    required this.total,
+    required this.threads,
+  });
+
+  final Duration map;
+  final Duration hash;
+  final Duration total;
+  final int threads;
+
+  @override
+  String toString() =>
+      'MediaManifestTimings(map: $map, hash: $hash, total: $total, '
+      'threads: $threads)';
+}
+
+/// Mirrors PravaMediaManifestTimings
+final class _ManifestTimings extends Struct {
+  @Uint64()
+  external int mapNs;
+
+  @Uint64()
+  external int hashNs;
+
+  @Uint64()
+  external int totalNs;
+
+  @Uint32()
+  external int threads;
+}
+
+final class _MediaManifestBindings {
+  _MediaManifestBindings(DynamicLibrary library)
+    : build = library
+          .lookupFunction<
+            Pointer<Void> Function(Pointer<Utf8>, Uint32),
+            Pointer<Void> Function(Pointer<Utf8>, int)
+          >('prava_media_manifest_build'),
+      size = library
+          .lookupFunction<
+            Uint64 Function(Pointer<Void>),
+            int Function(Pointer<Void>)
+          >('prava_media_manifest_size'),
+      chunkCount = library
+          .lookupFunction<
+            Uint32 Function(Pointer<Void>),
+            int Function(Pointer<Void>)
+          >('prava_media_manifest_chunk_count'),
+      root = library
+          .lookupFunction<
+            Pointer<Uint8> Function(Pointer<Void>),
+            Pointer<Uint8> Function(Pointer<Void>)
+          >('prava_media_manifest_root'),
+      digests = library
+          .lookupFunction<
+            Pointer<Uint8> Function(Pointer<Void>),
+            Pointer<Uint8> Function(Pointer<Void>)
+          >('prava_media_manifest_digests'),
+      chunk = library
+          .lookupFunction<
+            Pointer<Uint8> Function(Pointer<Void>, Uint32, Pointer<Uint32>),
+            Pointer<Uint8> Function(Pointer<Void>, int, Pointer<Uint32>)
+          >('prava_media_manifest_chunk'),
+      timings = library
+          .lookupFunction<
+            Void Function(Pointer<Void>, Pointer<_ManifestTimings>),
+            void Function(Pointer<Void>, Pointer<_ManifestTimings>)
+          >('prava_media_manifest_timings'),
+      close = library
+          .lookupFunction<
+            Void Function(Pointer<Void>),
+            void Function(Pointer<Void>)
+          >('prava_media_manifest_close');
+
+  static const String _libraryName = 'libprava_media.so';
+
+  static _MediaManifestBindings? load() {
+    if (!Platform.isLinux) return null;
+    try {
+      return _MediaManifestBindings(DynamicLibrary.open(_libraryName));
+    } catch (_) {
+      return null;
+    }
+  }
+
+  final Pointer<Void> Function(Pointer<Utf8>, int) build;
+  final int Function(Pointer<Void>) size;
+  final int Function(Pointer<Void>) chunkCount;
+  final Pointer<Uint8> Function(Pointer<Void>) root;
+  final Pointer<Uint8> Function(Pointer<Void>) digests;
+  final Pointer<Uint8> Function(Pointer<Void>, int, Pointer<Uint32>) chunk;
+  final void Function(Pointer<Void>, Pointer<_ManifestTimings>) timings;
+  final void Function(Pointer<Void>) close;
+}
@@ -1,5 +1,12 @@
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:http/http.dart' as http;
+
 import '../core/network/api_client.dart';
+import '../core/network/api_exception.dart';
 import '../core/storage/secure_store.dart';
+import 'media_manifest.dart';
 
 class MediaAsset {
   MediaAsset({
@@ -28,12 +35,40 @@ class MediaAsset {
   }
 }
 
+/// Progress of a chunked upload, reported after every chunk.
+class MediaUploadProgress {
+  const MediaUploadProgress({
+    required this.sentBytes,
+    required this.totalBytes,
+    required this.bytesPerSecond,
+    this.deduplicated = false,
+  });
+
+  /// Bytes the server holds, including chunks from an earlier attempt.
+  final int sentBytes;
+  final int totalBytes;
+
+  /// Upload throughput of this attempt.
+  final double bytesPerSecond;
+
+  /// The server already had this content; nothing was sent.
+  final bool deduplicated;
+
+  double get fraction => totalBytes == 0 ? 1 : sentBytes / totalBytes;
+}
+
 class MediaService {
   MediaService({SecureStore? store})
     : _client = ApiClient(store ?? SecureStore());
 
   final ApiClient _client;
 
+  /// Chunks in flight per upload.
+  static const int _chunkConcurrency = 4;
+
+  /// Tries per chunk before the upload is left for a later resume.
+  static const int _chunkAttempts = 3;
+
   Future<MediaAsset> uploadProfileImage({
     required String dataUri,
     String context = 'profile_avatar',
@@ -74,4 +109,162 @@ class MediaService {
         : <String, dynamic>{};
     return MediaAsset.fromJson(payload);
   }
+
+  /// Upload a chat attachment from disk, resumably.
+  Future<MediaAsset> uploadChatFile({
+    required String path,
+    required String mimeType,
+    required String resourceType,
+    String context = 'chat_attachment',
+    void Function(MediaUploadProgress progress)? onProgress,
+  }) async {
+    final manifest = await MediaManifest.build(path);
+    if (manifest == null) {
+      final bytes = await File(path).readAsBytes();
+      return uploadChatMedia(
+        dataUri: 'data:$mimeType;base64,${base64Encode(bytes)}',
+        resourceType: resourceType,
+        context: context,
+      );
+    }
+    try {
+      return await _uploadChunked(
+        manifest,
+        resourceType: resourceType,
+        folder: 'prava/chat',
+        context: context,
+        onProgress: onProgress,
+      );
+    } finally {
+      manifest.close();
+    }
+  }
+
+  /// Content-addressed chunked upload (see /media/uploads on the backend).
+  ///
+  /// A file this user already uploaded resolves to their existing asset
+  /// without sending any bytes; dedup never matches other users' media (a
+  /// forward sends the source message's asset id instead of uploading).
+  /// Otherwise only the chunks the server is missing are sent,
+  /// [_chunkConcurrency] at a time, so calling this again after a failure
+  /// resumes where the last attempt stopped.
+  Future<MediaAsset> _uploadChunked(
+    MediaManifest manifest, {
+    required String resourceType,
+    required String folder,
+    required String context,
+    void Function(MediaUploadProgress progress)? onProgress,
+  }) async {
+    final data = await _client.post(
+      '/media/uploads',
+      auth: true,
+      body: {
+        'contentHash': manifest.contentHash,
+        'totalBytes': manifest.size,
+        'chunkSize': manifest.chunkSize,
+        'chunkHashes': manifest.chunkHashes,
+        'resourceType': resourceType,
+        'folder': folder,
+        'context': context,
+      },
+    );
+    final payload = data is Map<String, dynamic> ? data : <String, dynamic>{};
+    if (payload['deduplicated'] == true) {
+      onProgress?.call(
+        MediaUploadProgress(
+          sentBytes: manifest.size,
+          totalBytes: manifest.size,
+          bytesPerSecond: 0,
+          deduplicated: true,
+        ),
+      );
+      return MediaAsset.fromJson(
+        payload['asset'] as Map<String, dynamic>? ?? {},
+      );
+    }
+
+    final upload = payload['upload'] as Map<String, dynamic>? ?? {};
+    final uploadId = upload['uploadId']?.toString() ?? '';
+    if (uploadId.isEmpty) {
+      throw ApiException(500, 'Upload could not be started');
+    }
+    final received = <int>{
+      for (final index in upload['receivedChunks'] as List? ?? const [])
+        if (index is num) index.toInt(),
+    };
+    final missing = [
+      for (var i = 0; i < manifest.chunkCount; i++)
+        if (!received.contains(i)) i,
+    ];
+
+    var sentBytes = received.fold<int>(
+      0,
+      (sum, index) => sum + manifest.chunkLength(index),
+    );
+    var attemptBytes = 0;
+    final stopwatch = Stopwatch()..start();
+    void report() {
+      final seconds = stopwatch.elapsedMicroseconds / 1e6;
+      onProgress?.call(
+        MediaUploadProgress(
+          sentBytes: sentBytes,
+          totalBytes: manifest.size,
+          bytesPerSecond: seconds > 0 ? attemptBytes / seconds : 0,
+        ),
+      );
+    }
+
+    report();
+    var next = 0;
+    var failed = false;
+    Future<void> worker() async {
+      while (!failed && next < missing.length) {
+        final index = missing[next++];
+        try {
+          await _putChunk(uploadId, index, manifest.chunk(index));
+        } catch (_) {
+          failed = true;
+          rethrow;
+        }
+        sentBytes += manifest.chunkLength(index);
+        attemptBytes += manifest.chunkLength(index);
+        report();
+      }
+    }
+
+    final workers = missing.length < _chunkConcurrency
+        ? missing.length
+        : _chunkConcurrency;
+    await Future.wait([for (var i = 0; i < workers; i++) worker()]);
+
+    final done = await _client.post(
+      '/media/uploads/$uploadId/complete',
+      auth: true,
+    );
+    final asset = done is Map<String, dynamic>
+        ? done['asset'] as Map<String, dynamic>? ?? {}
+        : <String, dynamic>{};
+    return MediaAsset.fromJson(asset);
+  }
+
+  /// PUT one chunk, retrying transient failures with backoff.
+  Future<void> _putChunk(String uploadId, int index, List<int> bytes) async {
+    for (var attempt = 1; ; attempt++) {
+      try {
+        await _client.putBytes(
+          '/media/uploads/$uploadId/chunks/$index',
+          bytes: bytes,
+          auth: true,
+        );
+        return;
+      } on ApiException catch (error) {
+        if (error.statusCode < 500 || attempt >= _chunkAttempts) rethrow;
+      } on SocketException {
+        if (attempt >= _chunkAttempts) rethrow;
+      } on http.ClientException {
+        if (attempt >= _chunkAttempts) rethrow;
+      }
+      await Future<void>.delayed(Duration(milliseconds: 400 * attempt));
+    }
+  }
 }
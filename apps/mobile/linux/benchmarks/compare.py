@@ -0,0 +1,143 @@
+"""Compare a Google Benchmark JSON report against baseline.json.
+
+    compare.py baseline.json results.json            # exit 1 on regression
+    compare.py baseline.json results.json --update   # record this core count
+
+Each benchmark is compared on its median real time (or the single run when
+the report has no aggregates). A benchmark regresses when it is slower than
+the baseline by more than its threshold; thresholds are per benchmark name
+in baseline.json, falling back to the default. Benchmarks missing from the
+report fail the check, new ones are listed so they can be added.
+
+Several kernels run on the worker pool, so their timings depend on the core
+count: baselines are kept per num_cpus and a report is only compared against
+the one recorded with its own core count. With no baseline for that count the
+check is skipped (exit 0) until one is recorded with --update on that class
+of machine.
+"""
+
+import argparse
+import json
+import sys
+
+DEFAULT_THRESHOLD = 0.15
+
+TO_NS = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+
+def load_results(path: str) -> tuple[dict, dict]:
+    with open(path, encoding='utf-8') as handle:
+        report = json.load(handle)
+
+    results = {}
+    for run in report.get('benchmarks', []):
+        if run.get('error_occurred'):
+            results[run['run_name']] = None
+            continue
+        # Prefer the median of repeated runs, which is robust to one slow
+        # repetition; fall back to the plain iteration when not repeated.
+        aggregate = run.get('aggregate_name')
+        if aggregate not in (None, 'median'):
+            continue
+        name = run.get('run_name', run['name'])
+        if aggregate is None and name in results:
+            continue
+        results[name] = run['real_time'] * TO_NS[run.get('time_unit', 'ns')]
+    return results, report.get('context', {})
+
+
+def baseline_key(context: dict) -> str:
+    return str(context.get('num_cpus', 'unknown'))
+
+
+def update(baseline_path: str, baseline: dict, results: dict, context: dict) -> int:
+    key = baseline_key(context)
+    recorded = {'mhz_per_cpu': context['mhz_per_cpu']} if 'mhz_per_cpu' in context else {}
+    recorded['benchmarks'] = {
+        name: {'real_time_ns': round(value, 1)}
+        for name, value in sorted(results.items())
+        if value is not None
+    }
+    baselines = baseline.setdefault('baselines', {})
+    baselines[key] = recorded
+    # Numeric keys in numeric order.
+    baseline['baselines'] = dict(sorted(baselines.items(), key=lambda item: (len(item[0]), item[0])))
+    with open(baseline_path, 'w', encoding='utf-8') as handle:
+        json.dump(baseline, handle, indent=2)
+        handle.write('\n')
+    print(
+        f'Recorded {len(recorded["benchmarks"])} benchmarks for num_cpus={key} '
+        f'in {baseline_path}'
+    )
+    return 0
+
+
+def compare(baseline: dict, results: dict, context: dict) -> int:
+    key = baseline_key(context)
+    recorded = baseline.get('baselines', {}).get(key)
+    if recorded is None:
+        known = ', '.join(sorted(baseline.get('baselines', {}))) or 'none'
+        print(
+            f'No baseline for num_cpus={key} (recorded: {known}); skipping the '
+            'comparison. Record one on this class of machine with --update.'
+        )
+        return 0
+    benchmarks = recorded.get('benchmarks', {})
+
+    thresholds = baseline.get('thresholds', {})
+    default = thresholds.get('default', DEFAULT_THRESHOLD)
+    failures = []
+
+    print(f'{"benchmark":<44} {"baseline":>12} {"current":>12} {"change":>8}  limit')
+    for name, expected in sorted(benchmarks.items()):
+        limit = thresholds.get(name, default)
+        base_ns = expected['real_time_ns']
+        current_ns = results.get(name)
+        if current_ns is None:
+            reason = 'failed' if name in results else 'missing'
+            print(f'{name:<44} {base_ns:>10.0f}ns {reason:>12}')
+            failures.append(name)
+            continue
+
+        change = current_ns / base_ns - 1
+        status = 'REGRESSED' if change > limit else ''
+        print(
+            f'{name:<44} {base_ns:>10.0f}ns {current_ns:>10.0f}ns '
+            f'{change:>+7.1%}  {limit:.0%} {status}'
+        )
+        if change > limit:
+            failures.append(name)
+
+    for name in sorted(set(results) - set(benchmarks)):
+        print(f'{name:<44} not in baseline (run with --update to add it)')
+
+    if failures:
+        print(f'\n{len(failures)} benchmark(s) regressed or failed: {", ".join(failures)}')
+        return 1
+    print('\nNo regressions.')
+    return 0
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('baseline')
+    parser.add_argument('results')
+    parser.add_argument('--update', action='store_true', help='overwrite the baseline with these results')
+    args = parser.parse_args()
+
+    try:
+        with open(args.baseline, encoding='utf-8') as handle:
+            baseline = json.load(handle)
+    except FileNotFoundError:
+        if not args.update:
+            raise
+        baseline = {'thresholds': {'default': DEFAULT_THRESHOLD}}
+
+    results, context = load_results(args.results)
+    if args.update:
+        return update(args.baseline, baseline, results, context)
+    return compare(baseline, results, context)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+
+#include <stdint.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "feed/feed_cache.h"
+#include "scratch_dir.h"
+
+namespace {
+
+// Mirror lib/core/storage/feed_cache.dart and lib/services/feed_service.dart.
+constexpr uint64_t kBudgetBytes = 16 * 1024 * 1024;
+constexpr uint32_t kMaxPages = 12;
+constexpr size_t kThumbnailsPerPage = 16;
+constexpr uint32_t kThumbnailSize = 12 * 1024;
+
+// One first page: the cache key FeedService builds (user|path|lens|scope) and
+// a response body in the shape the ranked feed endpoints return after
+// hydration. The pages are synthetic, not recorded from a backend, and only
+// the offline feed cache is timed here; ranking is not exercised.
+struct FeedPage {
+  std::string key;
+  std::string body;
+  std::vector<std::string> avatars;
+};
+
+std::vector<std::string> AvatarUrls(const std::string& body) {
+  static const std::string kField = "\"avatarUrl\":\"";
+  std::vector<std::string> urls;
+  size_t at = 0;
+  while (urls.size() < kThumbnailsPerPage &&
+         (at = body.find(kField, at)) != std::string::npos) {
+    at += kField.size();
+    const size_t end = body.find('"', at);
+    if (end == std::string::npos) break;
+    std::string url = body.substr(at, end - at);
+    bool seen = false;
+    for (const std::string& other : urls) seen = seen || other == url;
+    if (!seen && !url.empty()) urls.push_back(std::move(url));
+    at = end;
+  }
+  return urls;
+}
+
+// data/feed_pages.tsv (synthetic, see the README): one page per line, key
+// and body separated by a tab (JSON never contains a raw tab).
+const std::vector<FeedPage>& FeedPages() {
+  static const std::vector<FeedPage> pages = [] {
+    std::vector<FeedPage> loaded;
+    std::ifstream in(PRAVA_BENCHMARK_DATA_DIR "/feed_pages.tsv");
+    std::string line;
+    while (std::getline(in, line)) {
+      const size_t tab = line.find('\t');
+      if (tab == std::string::npos) continue;
+      FeedPage page;
+      page.key = line.substr(0, tab);
+      page.body = line.substr(tab + 1);
+      page.avatars = AvatarUrls(page.body);
+      loaded.push_back(std::move(page));
+    }
+    return loaded;
+  }();
+  return pages;
+}
+
+const uint8_t* Bytes(const std::string& value) {
+  return reinterpret_cast<const uint8_t*>(value.data());
+}
+
+bool Cached(void* cache, uint32_t kind, const std::string& key) {
+  void* snapshot = prava_feed_cache_snapshot(cache);
+  if (snapshot == nullptr) return false;
+  uint64_t offset = 0;
+  uint32_t length = 0;
+  const bool found =
+      prava_feed_snapshot_find(snapshot, kind, Bytes(key),
+                               static_cast<uint32_t>(key.size()), &offset,
+                               &length) != 0;
+  prava_feed_snapshot_release(snapshot);
+  return found;
+}
+
+// FeedService._storeFirstPage: the ranked page, the avatars not cached yet,
+// then one commit.
+bool StorePage(void* cache,
+               const FeedPage& page,
+               const std::vector<uint8_t>& thumbnail) {
+  if (!prava_feed_cache_put(cache, PRAVA_FEED_KIND_PAGE, Bytes(page.key),
+                            static_cast<uint32_t>(page.key.size()),
+                            Bytes(page.body),
+                            static_cast<uint32_t>(page.body.size()))) {
+    return false;
+  }
+  for (const std::string& url : page.avatars) {
+    if (Cached(cache, PRAVA_FEED_KIND_THUMBNAIL, url)) continue;
+    prava_feed_cache_put(cache, PRAVA_FEED_KIND_THUMBNAIL, Bytes(url),
+                         static_cast<uint32_t>(url.size()), thumbnail.data(),
+                         static_cast<uint32_t>(thumbnail.size()));
+  }
+  return prava_feed_cache_commit(cache) != 0;
+}
+
+// Stores the pages in order as successive feed refreshes into a cache that
+// is already full, so each iteration pays for staging, LRU
+// eviction and rewriting the file.
+void BM_FeedCacheStore(benchmark::State& state) {
+  const std::vector<FeedPage>& pages = FeedPages();
+  prava::ScratchDir scratch;
+  void* cache = prava_feed_cache_open(scratch.File("feed_cache.bin").c_str(),
+                                      kBudgetBytes, kMaxPages);
+  if (pages.empty() || !scratch.ok() || cache == nullptr) {
+    state.SkipWithError("feed pages or feed cache unavailable");
+    if (cache != nullptr) prava_feed_cache_close(cache);
+    return;
+  }
+  const std::vector<uint8_t> thumbnail(kThumbnailSize, 0x5a);
+  for (const FeedPage& page : pages) StorePage(cache, page, thumbnail);
+
+  size_t next = 0;
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    const FeedPage& page = pages[next];
+    next = (next + 1) % pages.size();
+    if (!StorePage(cache, page, thumbnail)) {
+      state.SkipWithError("feed cache commit failed");
+      break;
+    }
+    bytes += static_cast<int64_t>(page.body.size());
+  }
+  state.SetBytesProcessed(bytes);
+  prava_feed_cache_close(cache);
+}
+BENCHMARK(BM_FeedCacheStore)->Unit(benchmark::kMicrosecond);
+
+// Cold start: open the cache file left by the stores, map the committed
+// generation and find the first page, as FeedService.cachedFeedPage does
+// before the first frame. Only pages that survived eviction are looked up,
+// in turn, so every iteration times a hit.
+void BM_FeedCacheColdStart(benchmark::State& state) {
+  const std::vector<FeedPage>& pages = FeedPages();
+  prava::ScratchDir scratch;
+  const std::string path = scratch.File("feed_cache.bin");
+  void* cache = prava_feed_cache_open(path.c_str(), kBudgetBytes, kMaxPages);
+  if (pages.empty() || !scratch.ok() || cache == nullptr) {
+    state.SkipWithError("feed pages or feed cache unavailable");
+    if (cache != nullptr) prava_feed_cache_close(cache);
+    return;
+  }
+  const std::vector<uint8_t> thumbnail(kThumbnailSize, 0x5a);
+  for (const FeedPage& page : pages) StorePage(cache, page, thumbnail);
+
+  std::vector<const FeedPage*> cached;
+  void* stored = prava_feed_cache_snapshot(cache);
+  if (stored != nullptr) {
+    for (const FeedPage& page : pages) {
+      uint64_t offset = 0;
+      uint32_t length = 0;
+      if (prava_feed_snapshot_find(stored, PRAVA_FEED_KIND_PAGE,
+                                   Bytes(page.key),
+                                   static_cast<uint32_t>(page.key.size()),
+                                   &offset, &length)) {
+        cached.push_back(&page);
+      }
+    }
+    prava_feed_snapshot_release(stored);
+  }
+  prava_feed_cache_close(cache);
+  if (cached.empty()) {
+    state.SkipWithError("no pages cached");
+    return;
+  }
+
+  size_t next = 0;
+  for (auto _ : state) {
+    const FeedPage& page = *cached[next];
+    next = (next + 1) % cached.size();
+    void* reopened =
+        prava_feed_cache_open(path.c_str(), kBudgetBytes, kMaxPages);
+    void* snapshot = prava_feed_cache_snapshot(reopened);
+    if (snapshot == nullptr) {
+      state.SkipWithError("no committed generation");
+      prava_feed_cache_close(reopened);
+      break;
+    }
+    uint64_t size = 0;
+    const uint8_t* data = prava_feed_snapshot_data(snapshot, &size);
+    uint64_t offset = 0;
+    uint32_t length = 0;
+    if (!prava_feed_snapshot_find(snapshot, PRAVA_FEED_KIND_PAGE,
+                                  Bytes(page.key),
+                                  static_cast<uint32_t>(page.key.size()),
+                                  &offset, &length)) {
+      state.SkipWithError("cached page missing after reopen");
+      prava_feed_snapshot_release(snapshot);
+      prava_feed_cache_close(reopened);
+      break;
+    }
+    benchmark::DoNotOptimize(data[offset + length - 1]);
+    prava_feed_snapshot_release(snapshot);
+    prava_feed_cache_close(reopened);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FeedCacheColdStart)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "media/media_manifest.h"
+#include "scratch_dir.h"
+
+namespace {
+
+// MediaManifest.defaultChunkSize in lib/services/media_manifest.dart.
+constexpr uint32_t kChunkSize = 4 * 1024 * 1024;
+
+bool WritePattern(const std::string& path, size_t size) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) return false;
+  std::vector<uint8_t> block(1024 * 1024);
+  for (size_t i = 0; i < block.size(); ++i) {
+    block[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+  }
+  bool ok = true;
+  for (size_t written = 0; ok && written < size; written += block.size()) {
+    const size_t length = std::min(block.size(), size - written);
+    block[0] = static_cast<uint8_t>(written >> 20);
+    ok = fwrite(block.data(), 1, length, file) == length;
+  }
+  return fclose(file) == 0 && ok;
+}
+
+// Content address of an attachment before a chunked upload: map the file and
+// hash every chunk. The file stays in the page cache between iterations, so
+// this measures hashing and mapping rather than the disk.
+void BM_MediaManifestBuild(benchmark::State& state) {
+  const size_t size = static_cast<size_t>(state.range(0)) * 1024 * 1024;
+  prava::ScratchDir scratch;
+  const std::string path = scratch.File("attachment.bin");
+  if (!scratch.ok() || !WritePattern(path, size)) {
+    state.SkipWithError("could not write the media file");
+    return;
+  }
+
+  for (auto _ : state) {
+    void* manifest = prava_media_manifest_build(path.c_str(), kChunkSize);
+    if (manifest == nullptr) {
+      state.SkipWithError("prava_media_manifest_build failed");
+      break;
+    }
+    benchmark::DoNotOptimize(prava_media_manifest_root(manifest));
+    prava_media_manifest_close(manifest);
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+// A photo, a short clip and a longer video.
+BENCHMARK(BM_MediaManifestBuild)
+    ->Arg(3)
+    ->Arg(32)
+    ->Arg(128)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
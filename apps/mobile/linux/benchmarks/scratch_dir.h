@@ -0,0 +1,52 @@
+#ifndef PRAVA_BENCHMARKS_SCRATCH_DIR_H_
+#define PRAVA_BENCHMARKS_SCRATCH_DIR_H_
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+
+namespace prava {
+
+// Private temporary directory for one benchmark, removed with everything in
+// it when the benchmark finishes. Files go to $TMPDIR so a run can be pointed
+// at the same kind of storage the app uses.
+class ScratchDir {
+ public:
+  ScratchDir() {
+    const char* root = getenv("TMPDIR");
+    std::string pattern = std::string(root != nullptr && root[0] != '\0'
+                                          ? root
+                                          : "/tmp") +
+                          "/prava-bench-XXXXXX";
+    if (mkdtemp(&pattern[0]) != nullptr) path_ = pattern;
+  }
+
+  ~ScratchDir() {
+    if (path_.empty()) return;
+    nftw(path_.c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+  }
+
+  ScratchDir(const ScratchDir&) = delete;
+  ScratchDir& operator=(const ScratchDir&) = delete;
+
+  bool ok() const { return !path_.empty(); }
+  std::string File(const char* name) const { return path_ + "/" + name; }
+
+ private:
+  static int RemoveEntry(const char* path,
+                         const struct stat*,
+                         int,
+                         struct FTW*) {
+    remove(path);
+    return 0;
+  }
+
+  std::string path_;
+};
+
+}  // namespace prava
+
+#endif  // PRAVA_BENCHMARKS_SCRATCH_DIR_H_
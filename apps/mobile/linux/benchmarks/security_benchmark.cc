@@ -0,0 +1,172 @@
+#include <benchmark/benchmark.h>
+#include <sodium.h>
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "scratch_dir.h"
+#include "security/group_distribution.h"
+#include "security/prekey_batch.h"
+#include "security/session_cache.h"
+
+namespace {
+
+// Mirrors lib/security/storage/session_cache.dart.
+constexpr uint32_t kSessionCapacity = 256;
+constexpr uint32_t kSessionSyncIntervalMs = 25;
+constexpr uint32_t kSessionFlushThreshold = 128;
+// Typical encoded session record.
+constexpr uint32_t kSessionRecordSize = 1536;
+
+std::vector<uint8_t> RandomBytes(size_t size) {
+  std::vector<uint8_t> bytes(size);
+  randombytes_buf(bytes.data(), bytes.size());
+  return bytes;
+}
+
+std::string SessionKey(uint32_t index) {
+  return "session:usr_" + std::to_string(index) + ":device_1";
+}
+
+// Device registration and prekey top-up: one signed prekey plus |count|
+// one-time prekeys.
+void BM_PrekeyBatchGenerate(benchmark::State& state) {
+  const uint32_t count = static_cast<uint32_t>(state.range(0));
+  uint8_t public_key[crypto_sign_PUBLICKEYBYTES];
+  uint8_t secret_key[crypto_sign_SECRETKEYBYTES];
+  if (sodium_init() < 0 || crypto_sign_keypair(public_key, secret_key) != 0) {
+    state.SkipWithError("libsodium unavailable");
+    return;
+  }
+
+  uint32_t start_id = 1;
+  for (auto _ : state) {
+    void* batch = prava_prekey_batch_generate(start_id, count, secret_key, 1);
+    if (batch == nullptr) {
+      state.SkipWithError("prava_prekey_batch_generate failed");
+      break;
+    }
+    prava_prekey_batch_free(batch);
+    start_id += count;
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_PrekeyBatchGenerate)
+    ->Arg(100)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// Sender-key distribution sealed for every device of a group.
+void BM_DistributionSeal(benchmark::State& state) {
+  const uint32_t devices = static_cast<uint32_t>(state.range(0));
+  if (sodium_init() < 0) {
+    state.SkipWithError("libsodium unavailable");
+    return;
+  }
+  const std::vector<uint8_t> plaintext = RandomBytes(512);
+  const std::vector<uint8_t> steps =
+      RandomBytes(devices * prava::DistributionBatch::kStepSize);
+
+  for (auto _ : state) {
+    void* batch = prava_distribution_seal(
+        plaintext.data(), static_cast<uint32_t>(plaintext.size()),
+        steps.data(), devices);
+    if (batch == nullptr) {
+      state.SkipWithError("prava_distribution_seal failed");
+      break;
+    }
+    prava_distribution_free(batch);
+  }
+  state.SetItemsProcessed(state.iterations() * devices);
+}
+BENCHMARK(BM_DistributionSeal)
+    ->Arg(16)
+    ->Arg(256)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// Session lookup on the message decrypt path, cache warm.
+void BM_SessionCacheGet(benchmark::State& state) {
+  prava::ScratchDir scratch;
+  void* cache = prava_session_cache_open(
+      scratch.File("sessions.journal").c_str(), kSessionCapacity,
+      kSessionSyncIntervalMs);
+  if (!scratch.ok() || cache == nullptr) {
+    state.SkipWithError("prava_session_cache_open failed");
+    return;
+  }
+  const std::vector<uint8_t> record = RandomBytes(kSessionRecordSize);
+  std::vector<std::string> keys;
+  for (uint32_t i = 0; i < kSessionCapacity; ++i) {
+    keys.push_back(SessionKey(i));
+    prava_session_cache_prime(
+        cache, reinterpret_cast<const uint8_t*>(keys.back().data()),
+        static_cast<uint32_t>(keys.back().size()), record.data(),
+        kSessionRecordSize);
+  }
+
+  std::vector<uint8_t> out(4096);
+  uint32_t length = 0;
+  size_t next = 0;
+  for (auto _ : state) {
+    const std::string& key = keys[next];
+    next = (next + 1) % keys.size();
+    int32_t found = prava_session_cache_get(
+        cache, reinterpret_cast<const uint8_t*>(key.data()),
+        static_cast<uint32_t>(key.size()), out.data(),
+        static_cast<uint32_t>(out.size()), &length);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations());
+  prava_session_cache_close(cache);
+}
+BENCHMARK(BM_SessionCacheGet);
+
+// Ratchet step write-back: journaled put, with the Dart-side flush (drain
+// dirty records and checkpoint) every kSessionFlushThreshold puts.
+void BM_SessionCachePut(benchmark::State& state) {
+  prava::ScratchDir scratch;
+  void* cache = prava_session_cache_open(
+      scratch.File("sessions.journal").c_str(), kSessionCapacity,
+      kSessionSyncIntervalMs);
+  if (!scratch.ok() || cache == nullptr) {
+    state.SkipWithError("prava_session_cache_open failed");
+    return;
+  }
+  const std::vector<uint8_t> record = RandomBytes(kSessionRecordSize);
+  std::vector<std::string> keys;
+  for (uint32_t i = 0; i < kSessionCapacity; ++i) {
+    keys.push_back(SessionKey(i));
+  }
+
+  size_t next = 0;
+  uint32_t pending = 0;
+  for (auto _ : state) {
+    const std::string& key = keys[next];
+    next = (next + 1) % keys.size();
+    if (!prava_session_cache_put(
+            cache, reinterpret_cast<const uint8_t*>(key.data()),
+            static_cast<uint32_t>(key.size()), record.data(),
+            kSessionRecordSize)) {
+      state.SkipWithError("prava_session_cache_put failed");
+      break;
+    }
+    if (++pending == kSessionFlushThreshold) {
+      uint8_t* dirty = nullptr;
+      uint32_t size = 0;
+      uint32_t count = 0;
+      uint64_t generation =
+          prava_session_cache_take_dirty(cache, &dirty, &size, &count);
+      prava_session_cache_release(dirty);
+      prava_session_cache_checkpoint(cache, generation);
+      pending = 0;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  prava_session_cache_close(cache);
+}
+BENCHMARK(BM_SessionCachePut);
+
+}  // namespace
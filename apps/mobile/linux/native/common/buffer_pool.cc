@@ -0,0 +1,42 @@
+#include "common/buffer_pool.h"
+
+#include <sodium.h>
+
+namespace prava {
+
+BufferPool& BufferPool::Shared() {
+  static BufferPool* pool = new BufferPool();
+  return *pool;
+}
+
+BufferPool::Lease BufferPool::Acquire(size_t size) {
+  std::vector<uint8_t> buffer;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Prefer the smallest pooled buffer that already has the capacity.
+    size_t best = free_.size();
+    for (size_t i = 0; i < free_.size(); ++i) {
+      if (free_[i].capacity() >= size &&
+          (best == free_.size() ||
+           free_[i].capacity() < free_[best].capacity())) {
+        best = i;
+      }
+    }
+    if (best != free_.size()) {
+      buffer = std::move(free_[best]);
+      free_[best] = std::move(free_.back());
+      free_.pop_back();
+    }
+  }
+  buffer.resize(size);
+  return Lease(this, std::move(buffer));
+}
+
+void BufferPool::Release(std::vector<uint8_t> buffer) {
+  if (buffer.capacity() == 0 || buffer.capacity() > kMaxPooledBytes) return;
+  sodium_memzero(buffer.data(), buffer.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (free_.size() < kMaxPooledBuffers) free_.push_back(std::move(buffer));
+}
+
+}  // namespace prava
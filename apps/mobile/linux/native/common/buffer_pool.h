@@ -0,0 +1,74 @@
+#ifndef PRAVA_NATIVE_COMMON_BUFFER_POOL_H_
+#define PRAVA_NATIVE_COMMON_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace prava {
+
+// Recycles byte buffers between calls so hot kernels do not hit the
+// allocator once per batch. Buffers are returned wiped; secrets should still
+// live in sodium_malloc memory rather than here.
+class BufferPool {
+ public:
+  // RAII handle; gives the buffer back to the pool when destroyed.
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(Lease&& other) noexcept
+        : pool_(other.pool_), buffer_(std::move(other.buffer_)) {
+      other.pool_ = nullptr;
+    }
+    Lease& operator=(Lease&& other) noexcept {
+      if (this != &other) {
+        Reset();
+        pool_ = other.pool_;
+        buffer_ = std::move(other.buffer_);
+        other.pool_ = nullptr;
+      }
+      return *this;
+    }
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease() { Reset(); }
+
+    uint8_t* data() { return buffer_.data(); }
+    const uint8_t* data() const { return buffer_.data(); }
+    size_t size() const { return buffer_.size(); }
+
+   private:
+    friend class BufferPool;
+    Lease(BufferPool* pool, std::vector<uint8_t> buffer)
+        : pool_(pool), buffer_(std::move(buffer)) {}
+
+    void Reset() {
+      if (pool_ != nullptr) pool_->Release(std::move(buffer_));
+      pool_ = nullptr;
+    }
+
+    BufferPool* pool_ = nullptr;
+    std::vector<uint8_t> buffer_;
+  };
+
+  static BufferPool& Shared();
+
+  // Returns a buffer of exactly |size| bytes (contents unspecified).
+  Lease Acquire(size_t size);
+
+ private:
+  // Buffers larger than this are freed instead of pooled.
+  static constexpr size_t kMaxPooledBytes = 8 * 1024 * 1024;
+  static constexpr size_t kMaxPooledBuffers = 32;
+
+  void Release(std::vector<uint8_t> buffer);
+
+  std::mutex mutex_;
+  std::vector<std::vector<uint8_t>> free_;
+};
+
+}  // namespace prava
+
+#endif  // PRAVA_NATIVE_COMMON_BUFFER_POOL_H_
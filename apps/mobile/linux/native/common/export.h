@@ -0,0 +1,13 @@
+#ifndef PRAVA_NATIVE_COMMON_EXPORT_H_
+#define PRAVA_NATIVE_COMMON_EXPORT_H_
+
+// Marks a function as part of the C ABI that Dart binds through dart:ffi.
+// The native libraries are built with hidden visibility, so anything not
+// tagged with this macro stays private to the shared object.
+#ifdef __cplusplus
+#define PRAVA_EXPORT extern "C" __attribute__((visibility("default")))
+#else
+#define PRAVA_EXPORT __attribute__((visibility("default")))
+#endif
+
+#endif  // PRAVA_NATIVE_COMMON_EXPORT_H_
@@ -0,0 +1,32 @@
+#ifndef PRAVA_NATIVE_COMMON_LITTLE_ENDIAN_H_
+#define PRAVA_NATIVE_COMMON_LITTLE_ENDIAN_H_
+
+#include <cstdint>
+
+namespace prava {
+
+// Fixed little-endian encoding for on-disk formats, independent of the host.
+
+inline void WriteU32LE(uint8_t* out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+inline void WriteU64LE(uint8_t* out, uint64_t value) {
+  for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+inline uint32_t ReadU32LE(const uint8_t* in) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; --i) value = (value << 8) | in[i];
+  return value;
+}
+
+inline uint64_t ReadU64LE(const uint8_t* in) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; --i) value = (value << 8) | in[i];
+  return value;
+}
+
+}  // namespace prava
+
+#endif  // PRAVA_NATIVE_COMMON_LITTLE_ENDIAN_H_
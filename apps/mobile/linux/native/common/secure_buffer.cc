@@ -0,0 +1,77 @@
+#include "common/secure_buffer.h"
+
+#include <sodium.h>
+
+#include <cstring>
+#include <utility>
+
+namespace prava {
+
+namespace {
+
+// Every sodium_malloc call maps guard pages, so grow geometrically.
+constexpr size_t kMinCapacity = 4096;
+
+}  // namespace
+
+SecureBuffer::SecureBuffer(SecureBuffer&& other) noexcept
+    : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.capacity_ = 0;
+}
+
+SecureBuffer& SecureBuffer::operator=(SecureBuffer&& other) noexcept {
+  if (this != &other) {
+    Reset();
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+  }
+  return *this;
+}
+
+SecureBuffer::~SecureBuffer() { Reset(); }
+
+bool SecureBuffer::Resize(size_t size) {
+  if (!Reserve(size)) return false;
+  if (size < size_) sodium_memzero(data_ + size, size_ - size);
+  size_ = size;
+  return true;
+}
+
+bool SecureBuffer::Append(const uint8_t* data, size_t size) {
+  if (size == 0) return true;
+  const size_t offset = size_;
+  if (!Resize(offset + size)) return false;
+  std::memcpy(data_ + offset, data, size);
+  return true;
+}
+
+void SecureBuffer::Clear() {
+  if (size_ > 0) sodium_memzero(data_, size_);
+  size_ = 0;
+}
+
+void SecureBuffer::Reset() {
+  // sodium_free wipes the whole allocation.
+  if (data_ != nullptr) sodium_free(data_);
+  data_ = nullptr;
+  size_ = 0;
+  capacity_ = 0;
+}
+
+bool SecureBuffer::Reserve(size_t capacity) {
+  if (capacity <= capacity_) return true;
+  size_t grown = capacity_ == 0 ? kMinCapacity : capacity_;
+  while (grown < capacity) grown *= 2;
+  uint8_t* data = static_cast<uint8_t*>(sodium_malloc(grown));
+  if (data == nullptr) return false;
+  if (size_ > 0) std::memcpy(data, data_, size_);
+  if (data_ != nullptr) sodium_free(data_);
+  data_ = data;
+  capacity_ = grown;
+  return true;
+}
+
+}  // namespace prava
@@ -0,0 +1,45 @@
+#ifndef PRAVA_NATIVE_COMMON_SECURE_BUFFER_H_
+#define PRAVA_NATIVE_COMMON_SECURE_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace prava {
+
+// Growable byte buffer in sodium_malloc memory: guarded, mlocked where the
+// limit allows and wiped when freed. For copies of key material that
+// BufferPool (plain heap, swappable) must not hold. Not thread-safe.
+class SecureBuffer {
+ public:
+  SecureBuffer() = default;
+  SecureBuffer(SecureBuffer&& other) noexcept;
+  SecureBuffer& operator=(SecureBuffer&& other) noexcept;
+  SecureBuffer(const SecureBuffer&) = delete;
+  SecureBuffer& operator=(const SecureBuffer&) = delete;
+  ~SecureBuffer();
+
+  // Sets the size to |size|, keeping the first min(size, old size) bytes.
+  // Returns false (buffer unchanged) if the allocation failed.
+  bool Resize(size_t size);
+  bool Append(const uint8_t* data, size_t size);
+  // Wipes the contents; the allocation is kept for reuse.
+  void Clear();
+  // Frees the allocation.
+  void Reset();
+
+  uint8_t* data() { return data_; }
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  bool Reserve(size_t capacity);
+
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+}  // namespace prava
+
+#endif  // PRAVA_NATIVE_COMMON_SECURE_BUFFER_H_
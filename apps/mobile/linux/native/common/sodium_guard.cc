@@ -0,0 +1,16 @@
+#include "common/sodium_guard.h"
+
+#include <sodium.h>
+
+#include <mutex>
+
+namespace prava {
+
+bool EnsureSodium() {
+  static std::once_flag once;
+  static bool ready = false;
+  std::call_once(once, [] { ready = sodium_init() >= 0; });
+  return ready;
+}
+
+}  // namespace prava
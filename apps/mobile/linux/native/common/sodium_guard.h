@@ -0,0 +1,13 @@
+#ifndef PRAVA_NATIVE_COMMON_SODIUM_GUARD_H_
+#define PRAVA_NATIVE_COMMON_SODIUM_GUARD_H_
+
+namespace prava {
+
+// Initializes libsodium exactly once per process. Safe to call from any
+// thread; returns false if the library could not be initialized, in which
+// case callers must fail the operation and let Dart fall back.
+bool EnsureSodium();
+
+}  // namespace prava
+
+#endif  // PRAVA_NATIVE_COMMON_SODIUM_GUARD_H_
@@ -0,0 +1,40 @@
+#ifndef PRAVA_NATIVE_COMMON_STOPWATCH_H_
+#define PRAVA_NATIVE_COMMON_STOPWATCH_H_
+
+#include <chrono>
+#include <cstdint>
+
+namespace prava {
+
+// Monotonic stopwatch used for the timing counters the native kernels report
+// back to Dart. Values are in nanoseconds.
+class Stopwatch {
+ public:
+  Stopwatch() : start_(Clock::now()) {}
+
+  void Reset() { start_ = Clock::now(); }
+
+  uint64_t ElapsedNs() const {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             start_)
+            .count());
+  }
+
+  // Returns the time since the last lap (or construction) and restarts.
+  uint64_t LapNs() {
+    const auto now = Clock::now();
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_);
+    start_ = now;
+    return static_cast<uint64_t>(elapsed.count());
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start_;
+};
+
+}  // namespace prava
+
+#endif  // PRAVA_NATIVE_COMMON_STOPWATCH_H_
@@ -0,0 +1,105 @@
+#include "common/worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace prava {
+
+namespace {
+
+thread_local bool tls_in_worker = false;
+
+}  // namespace
+
+struct WorkerPool::Job {
+  const RangeFn* fn;
+  size_t count;
+  size_t grain;
+  std::atomic<size_t> next{0};
+};
+
+WorkerPool& WorkerPool::Shared() {
+  static WorkerPool* pool = [] {
+    const unsigned cores = std::thread::hardware_concurrency();
+    return new WorkerPool(cores > 1 ? cores - 1 : 0);
+  }();
+  return *pool;
+}
+
+WorkerPool::WorkerPool(size_t workers) {
+  threads_.reserve(workers);
+  for (size_t i = 0; i < workers; ++i) {
+    threads_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::ParallelFor(size_t count, size_t grain, const RangeFn& fn) {
+  if (count == 0) return;
+  grain = std::max<size_t>(grain, 1);
+  if (threads_.empty() || count <= grain || tls_in_worker) {
+    fn(0, count);
+    return;
+  }
+
+  std::lock_guard<std::mutex> submit(submit_mutex_);
+  Job job;
+  job.fn = &fn;
+  job.count = count;
+  job.grain = grain;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = &job;
+    ++generation_;
+  }
+  wake_.notify_all();
+
+  tls_in_worker = true;
+  Drain(&job);
+  tls_in_worker = false;
+
+  // Unpublish the job so late wakers skip it, then wait for the workers that
+  // did pick it up to finish their last chunk.
+  std::unique_lock<std::mutex> lock(mutex_);
+  job_ = nullptr;
+  idle_.wait(lock, [this] { return active_ == 0; });
+}
+
+void WorkerPool::WorkerLoop() {
+  tls_in_worker = true;
+  uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [&] {
+      return stopping_ || (job_ != nullptr && generation_ != seen);
+    });
+    if (stopping_) return;
+    seen = generation_;
+    Job* job = job_;
+    ++active_;
+    lock.unlock();
+    Drain(job);
+    lock.lock();
+    if (--active_ == 0) idle_.notify_all();
+  }
+}
+
+void WorkerPool::Drain(Job* job) {
+  for (;;) {
+    const size_t begin = job->next.fetch_add(job->grain);
+    if (begin >= job->count) return;
+    (*job->fn)(begin, std::min(begin + job->grain, job->count));
+  }
+}
+
+}  // namespace prava
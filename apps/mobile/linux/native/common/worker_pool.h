@@ -0,0 +1,59 @@
+#ifndef PRAVA_NATIVE_COMMON_WORKER_POOL_H_
+#define PRAVA_NATIVE_COMMON_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace prava {
+
+// Fixed-size pool of worker threads shared by the native kernels.
+//
+// Work is expressed as a ParallelFor over an index range; the calling thread
+// takes part in the loop, so a pool with N workers runs on N + 1 cores. Only
+// one ParallelFor runs at a time. Calls made from inside a worker run inline
+// instead of deadlocking on the pool.
+class WorkerPool {
+ public:
+  using RangeFn = std::function<void(size_t begin, size_t end)>;
+
+  // Process-wide pool sized to the number of online cores.
+  static WorkerPool& Shared();
+
+  explicit WorkerPool(size_t workers);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Number of threads that take part in a ParallelFor, including the caller.
+  size_t concurrency() const { return threads_.size() + 1; }
+
+  // Invokes |fn| over [0, count) in chunks of at most |grain| indices and
+  // blocks until every chunk has completed. |fn| must not throw.
+  void ParallelFor(size_t count, size_t grain, const RangeFn& fn);
+
+ private:
+  struct Job;
+
+  void WorkerLoop();
+  static void Drain(Job* job);
+
+  std::vector<std::thread> threads_;
+  std::mutex submit_mutex_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  Job* job_ = nullptr;
+  uint64_t generation_ = 0;
+  size_t active_ = 0;
+  bool stopping_ = false;
+};
+
+}  // namespace prava
+
+#endif  // PRAVA_NATIVE_COMMON_WORKER_POOL_H_
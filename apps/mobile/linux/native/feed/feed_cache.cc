@@ -0,0 +1,459 @@
+#include "feed/feed_cache.h"
+
+#include <fcntl.h>
+#include <sodium.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "common/little_endian.h"
+#include "common/sodium_guard.h"
+
+namespace prava {
+
+namespace {
+
+// Header layout (little endian):
+//   [magic : u32][format : u32][generation : u64][count : u32][reserved : 4]
+//   [file size : u64][BLAKE2b-128 of header[0..32) + index : 16][reserved]
+// Bump kFormatVersion whenever the layout changes; older files are ignored
+// and replaced on the next commit.
+constexpr uint32_t kMagic = 0x31434650;  // "PFC1"
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kHeaderSize = 64;
+constexpr size_t kChecksumOffset = 32;
+constexpr size_t kChecksumSize = 16;
+constexpr size_t kIndexEntrySize = 48;
+constexpr size_t kAlignment = 16;
+
+uint64_t NowMs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+uint64_t Align(uint64_t offset) {
+  return (offset + kAlignment - 1) & ~static_cast<uint64_t>(kAlignment - 1);
+}
+
+void IndexChecksum(const uint8_t* header,
+                   const uint8_t* index,
+                   size_t index_size,
+                   uint8_t* out) {
+  crypto_generichash_state state;
+  crypto_generichash_init(&state, nullptr, 0, kChecksumSize);
+  crypto_generichash_update(&state, header, kChecksumOffset);
+  crypto_generichash_update(&state, index, index_size);
+  crypto_generichash_final(&state, out, kChecksumSize);
+}
+
+bool WriteAll(int fd, const uint8_t* data, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+void SyncParentDirectory(const std::string& path) {
+  size_t slash = path.rfind('/');
+  std::string directory =
+      slash == std::string::npos ? "." : path.substr(0, slash);
+  int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) return;
+  fsync(fd);
+  close(fd);
+}
+
+}  // namespace
+
+FeedSnapshot* FeedSnapshot::Map(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return nullptr;
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      static_cast<uint64_t>(info.st_size) < kHeaderSize) {
+    close(fd);
+    return nullptr;
+  }
+  size_t size = static_cast<size_t>(info.st_size);
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) return nullptr;
+
+  FeedSnapshot* snapshot = new FeedSnapshot();
+  snapshot->data_ = static_cast<uint8_t*>(mapped);
+  snapshot->size_ = size;
+
+  const uint8_t* header = snapshot->data_;
+  uint32_t count = ReadU32LE(header + 16);
+  uint64_t index_size = static_cast<uint64_t>(count) * kIndexEntrySize;
+  bool valid = ReadU32LE(header) == kMagic &&
+               ReadU32LE(header + 4) == kFormatVersion &&
+               ReadU64LE(header + 24) == size &&
+               index_size <= size - kHeaderSize;
+  if (valid) {
+    uint8_t checksum[kChecksumSize];
+    IndexChecksum(header, header + kHeaderSize, index_size, checksum);
+    valid = sodium_memcmp(checksum, header + kChecksumOffset,
+                          kChecksumSize) == 0;
+  }
+
+  for (uint32_t i = 0; valid && i < count; ++i) {
+    const uint8_t* record = header + kHeaderSize + i * kIndexEntrySize;
+    Entry entry;
+    entry.kind = ReadU32LE(record);
+    entry.key_length = ReadU32LE(record + 4);
+    entry.value_length = ReadU32LE(record + 8);
+    entry.key_offset = ReadU64LE(record + 16);
+    entry.value_offset = ReadU64LE(record + 24);
+    entry.last_used_ms = ReadU64LE(record + 32);
+    entry.stored_at_ms = ReadU64LE(record + 40);
+    valid = entry.key_offset <= size &&
+            entry.key_length <= size - entry.key_offset &&
+            entry.value_offset <= size &&
+            entry.value_length <= size - entry.value_offset;
+    snapshot->entries_.push_back(entry);
+  }
+  if (!valid) {
+    snapshot->Release();
+    return nullptr;
+  }
+
+  snapshot->generation_ = ReadU64LE(header + 8);
+  // The whole file is read on the first frame; ask for it up front.
+  madvise(snapshot->data_, size, MADV_WILLNEED);
+  return snapshot;
+}
+
+FeedSnapshot::~FeedSnapshot() {
+  if (data_ != nullptr) munmap(data_, size_);
+}
+
+void FeedSnapshot::Release() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+}
+
+int FeedSnapshot::Find(uint32_t kind,
+                       const uint8_t* key,
+                       uint32_t key_length) const {
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const Entry& entry = entries_[i];
+    if (entry.kind == kind && entry.key_length == key_length &&
+        std::memcmp(data_ + entry.key_offset, key, key_length) == 0) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+std::unique_ptr<FeedCache> FeedCache::Open(const std::string& path,
+                                           uint64_t budget_bytes,
+                                           uint32_t max_pages) {
+  if (path.empty() || budget_bytes <= kHeaderSize || max_pages == 0) {
+    return nullptr;
+  }
+  if (!EnsureSodium()) return nullptr;
+
+  std::unique_ptr<FeedCache> cache(
+      new FeedCache(path, budget_bytes, max_pages));
+  cache->snapshot_ = FeedSnapshot::Map(path);
+  if (cache->snapshot_ != nullptr) {
+    FeedSnapshot* snapshot = cache->snapshot_;
+    cache->generation_ = snapshot->generation();
+    for (const FeedSnapshot::Entry& mapped : snapshot->entries()) {
+      Entry entry;
+      entry.kind = mapped.kind;
+      entry.key.assign(
+          reinterpret_cast<const char*>(snapshot->data() + mapped.key_offset),
+          mapped.key_length);
+      entry.last_used_ms = mapped.last_used_ms;
+      entry.stored_at_ms = mapped.stored_at_ms;
+      entry.value_offset = mapped.value_offset;
+      entry.value_length = mapped.value_length;
+      cache->entries_.push_back(std::move(entry));
+    }
+  }
+  return cache;
+}
+
+FeedCache::FeedCache(std::string path,
+                     uint64_t budget_bytes,
+                     uint32_t max_pages)
+    : path_(std::move(path)),
+      budget_bytes_(budget_bytes),
+      max_pages_(max_pages) {}
+
+FeedCache::~FeedCache() {
+  if (snapshot_ != nullptr) snapshot_->Release();
+}
+
+FeedSnapshot* FeedCache::AcquireSnapshot() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (snapshot_ == nullptr) return nullptr;
+  snapshot_->Acquire();
+  return snapshot_;
+}
+
+bool FeedCache::Put(uint32_t kind,
+                    const uint8_t* key,
+                    uint32_t key_length,
+                    const uint8_t* value,
+                    uint32_t value_length) {
+  if (key_length == 0 ||
+      Align(kHeaderSize + kIndexEntrySize + key_length) + value_length >
+          budget_bytes_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry* entry = FindLocked(kind, key, key_length);
+  if (entry == nullptr) {
+    entries_.emplace_back();
+    entry = &entries_.back();
+    entry->kind = kind;
+    entry->key.assign(reinterpret_cast<const char*>(key), key_length);
+  }
+  uint64_t now = NowMs();
+  entry->staged = true;
+  entry->value.assign(value, value + value_length);
+  entry->value_length = value_length;
+  entry->last_used_ms = now;
+  entry->stored_at_ms = now;
+  dirty_ = true;
+  return true;
+}
+
+void FeedCache::Touch(uint32_t kind, const uint8_t* key, uint32_t key_length) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry* entry = FindLocked(kind, key, key_length);
+  if (entry == nullptr) return;
+  entry->last_used_ms = NowMs();
+  dirty_ = true;
+}
+
+bool FeedCache::Commit() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty_) return true;
+  EvictLocked();
+
+  uint64_t cursor = kHeaderSize + entries_.size() * kIndexEntrySize;
+  std::vector<uint64_t> key_offsets(entries_.size());
+  std::vector<uint64_t> value_offsets(entries_.size());
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    key_offsets[i] = cursor = Align(cursor);
+    value_offsets[i] = cursor = Align(cursor + entries_[i].key.size());
+    cursor += entries_[i].value_length;
+  }
+  uint64_t size = cursor;
+
+  std::vector<uint8_t> file(size, 0);
+  uint8_t* header = file.data();
+  uint8_t* index = header + kHeaderSize;
+  uint64_t generation = generation_ + 1;
+  WriteU32LE(header, kMagic);
+  WriteU32LE(header + 4, kFormatVersion);
+  WriteU64LE(header + 8, generation);
+  WriteU32LE(header + 16, static_cast<uint32_t>(entries_.size()));
+  WriteU64LE(header + 24, size);
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const Entry& entry = entries_[i];
+    uint8_t* record = index + i * kIndexEntrySize;
+    WriteU32LE(record, entry.kind);
+    WriteU32LE(record + 4, static_cast<uint32_t>(entry.key.size()));
+    WriteU32LE(record + 8, entry.value_length);
+    WriteU64LE(record + 16, key_offsets[i]);
+    WriteU64LE(record + 24, value_offsets[i]);
+    WriteU64LE(record + 32, entry.last_used_ms);
+    WriteU64LE(record + 40, entry.stored_at_ms);
+
+    std::memcpy(header + key_offsets[i], entry.key.data(), entry.key.size());
+    const uint8_t* value = entry.staged
+                               ? entry.value.data()
+                               : snapshot_->data() + entry.value_offset;
+    if (entry.value_length > 0) {
+      std::memcpy(header + value_offsets[i], value, entry.value_length);
+    }
+  }
+  IndexChecksum(header, index, entries_.size() * kIndexEntrySize,
+                header + kChecksumOffset);
+
+  // Readers keep mapping the previous generation until they drop it; the
+  // rename swaps the directory entry, never the bytes under a mapping.
+  std::string temp_path = path_ + ".tmp";
+  int fd = open(temp_path.c_str(),
+                O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) return false;
+  bool written = WriteAll(fd, file.data(), file.size()) && fdatasync(fd) == 0;
+  close(fd);
+  if (!written || rename(temp_path.c_str(), path_.c_str()) != 0) {
+    unlink(temp_path.c_str());
+    return false;
+  }
+  SyncParentDirectory(path_);
+
+  FeedSnapshot* snapshot = FeedSnapshot::Map(path_);
+  if (snapshot == nullptr) return false;
+  if (snapshot_ != nullptr) snapshot_->Release();
+  snapshot_ = snapshot;
+  generation_ = generation;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    Entry& entry = entries_[i];
+    entry.staged = false;
+    std::vector<uint8_t>().swap(entry.value);
+    entry.value_offset = value_offsets[i];
+  }
+  dirty_ = false;
+  return true;
+}
+
+bool FeedCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  if (snapshot_ != nullptr) snapshot_->Release();
+  snapshot_ = nullptr;
+  ++generation_;
+  dirty_ = false;
+  return unlink(path_.c_str()) == 0 || errno == ENOENT;
+}
+
+FeedCache::Entry* FeedCache::FindLocked(uint32_t kind,
+                                        const uint8_t* key,
+                                        uint32_t key_length) {
+  for (Entry& entry : entries_) {
+    if (entry.kind == kind && entry.key.size() == key_length &&
+        std::memcmp(entry.key.data(), key, key_length) == 0) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+void FeedCache::EvictLocked() {
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const Entry& a, const Entry& b) {
+                     return a.last_used_ms > b.last_used_ms;
+                   });
+
+  // Walk from most to least recently used and keep what fits. A large stale
+  // entry is dropped without evicting smaller, more recent ones after it.
+  uint64_t used = kHeaderSize;
+  uint32_t pages = 0;
+  std::vector<Entry> kept;
+  kept.reserve(entries_.size());
+  for (Entry& entry : entries_) {
+    uint64_t cost = kIndexEntrySize + Align(entry.key.size()) +
+                    Align(entry.value_length);
+    bool is_page = entry.kind == PRAVA_FEED_KIND_PAGE;
+    if ((is_page && pages >= max_pages_) || used + cost > budget_bytes_) {
+      continue;
+    }
+    used += cost;
+    if (is_page) ++pages;
+    kept.push_back(std::move(entry));
+  }
+  entries_.swap(kept);
+}
+
+}  // namespace prava
+
+void* prava_feed_cache_open(const char* path,
+                            uint64_t budget_bytes,
+                            uint32_t max_pages) {
+  if (path == nullptr) return nullptr;
+  return prava::FeedCache::Open(path, budget_bytes, max_pages).release();
+}
+
+void* prava_feed_cache_snapshot(void* cache) {
+  if (cache == nullptr) return nullptr;
+  return static_cast<prava::FeedCache*>(cache)->AcquireSnapshot();
+}
+
+int32_t prava_feed_cache_put(void* cache,
+                             uint32_t kind,
+                             const uint8_t* key,
+                             uint32_t key_length,
+                             const uint8_t* value,
+                             uint32_t value_length) {
+  if (cache == nullptr || key == nullptr) return 0;
+  if (value == nullptr && value_length != 0) return 0;
+  return static_cast<prava::FeedCache*>(cache)->Put(kind, key, key_length,
+                                                    value, value_length);
+}
+
+void prava_feed_cache_touch(void* cache,
+                            uint32_t kind,
+                            const uint8_t* key,
+                            uint32_t key_length) {
+  if (cache == nullptr || key == nullptr) return;
+  static_cast<prava::FeedCache*>(cache)->Touch(kind, key, key_length);
+}
+
+int32_t prava_feed_cache_commit(void* cache) {
+  if (cache == nullptr) return 0;
+  return static_cast<prava::FeedCache*>(cache)->Commit();
+}
+
+int32_t prava_feed_cache_clear(void* cache) {
+  if (cache == nullptr) return 0;
+  return static_cast<prava::FeedCache*>(cache)->Clear();
+}
+
+void prava_feed_cache_close(void* cache) {
+  delete static_cast<prava::FeedCache*>(cache);
+}
+
+const uint8_t* prava_feed_snapshot_data(void* snapshot, uint64_t* size) {
+  if (snapshot == nullptr || size == nullptr) return nullptr;
+  auto* mapped = static_cast<prava::FeedSnapshot*>(snapshot);
+  *size = mapped->size();
+  return mapped->data();
+}
+
+uint64_t prava_feed_snapshot_generation(void* snapshot) {
+  if (snapshot == nullptr) return 0;
+  return static_cast<prava::FeedSnapshot*>(snapshot)->generation();
+}
+
+int32_t prava_feed_snapshot_find(void* snapshot,
+                                 uint32_t kind,
+                                 const uint8_t* key,
+                                 uint32_t key_length,
+                                 uint64_t* offset,
+                                 uint32_t* length) {
+  if (snapshot == nullptr || key == nullptr || offset == nullptr ||
+      length == nullptr) {
+    return 0;
+  }
+  auto* mapped = static_cast<prava::FeedSnapshot*>(snapshot);
+  int found = mapped->Find(kind, key, key_length);
+  if (found < 0) return 0;
+  const prava::FeedSnapshot::Entry& entry = mapped->entries()[found];
+  *offset = entry.value_offset;
+  *length = entry.value_length;
+  return 1;
+}
+
+void prava_feed_snapshot_release(void* snapshot) {
+  if (snapshot != nullptr) {
+    static_cast<prava::FeedSnapshot*>(snapshot)->Release();
+  }
+}
+
+void prava_feed_cache_prefetch(const char* path) {
+  if (path == nullptr) return;
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+  close(fd);
+}
@@ -0,0 +1,174 @@
+#ifndef PRAVA_NATIVE_FEED_FEED_CACHE_H_
+#define PRAVA_NATIVE_FEED_FEED_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/export.h"
+
+// Entry kinds stored in the cache file.
+#define PRAVA_FEED_KIND_PAGE 1
+#define PRAVA_FEED_KIND_THUMBNAIL 2
+
+#ifdef __cplusplus
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace prava {
+
+// One committed generation of the cache file, mapped read-only.
+//
+// Snapshots are reference counted so Dart can hold zero-copy views into the
+// mapping (released through a NativeFinalizer) while newer generations are
+// committed. The mapping is unmapped when the last reference goes away.
+class FeedSnapshot {
+ public:
+  struct Entry {
+    uint32_t kind;
+    uint32_t key_length;
+    uint32_t value_length;
+    uint64_t key_offset;
+    uint64_t value_offset;
+    uint64_t last_used_ms;
+    uint64_t stored_at_ms;
+  };
+
+  // Maps |path| and validates header, index checksum and entry bounds.
+  // Returns nullptr when the file is missing, foreign or corrupt.
+  static FeedSnapshot* Map(const std::string& path);
+
+  void Acquire() { refs_.fetch_add(1, std::memory_order_relaxed); }
+  void Release();
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+  uint64_t generation() const { return generation_; }
+  const std::vector<Entry>& entries() const { return entries_; }
+
+  // Index of the entry for |kind| / |key|, or -1.
+  int Find(uint32_t kind, const uint8_t* key, uint32_t key_length) const;
+
+ private:
+  FeedSnapshot() = default;
+  ~FeedSnapshot();
+
+  std::atomic<int> refs_{1};
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  uint64_t generation_ = 0;
+  std::vector<Entry> entries_;
+};
+
+// Offline store for the last ranked feed pages and their thumbnails.
+//
+// The cache is a single versioned file:
+//   [header : 64][index : 48 * count][keys and values, 16-byte aligned]
+// Writes are staged in memory and Commit() rewrites the file to a temporary
+// path and renames it into place, so readers only ever see a complete
+// generation. Entries are evicted least-recently-used first until at most
+// |max_pages| pages remain and the file fits in |budget_bytes|.
+class FeedCache {
+ public:
+  static std::unique_ptr<FeedCache> Open(const std::string& path,
+                                         uint64_t budget_bytes,
+                                         uint32_t max_pages);
+  ~FeedCache();
+
+  FeedCache(const FeedCache&) = delete;
+  FeedCache& operator=(const FeedCache&) = delete;
+
+  // Current committed generation with an extra reference for the caller, or
+  // nullptr when nothing has been committed yet.
+  FeedSnapshot* AcquireSnapshot();
+
+  // Stages |value| for |kind| / |key|, replacing any previous value.
+  bool Put(uint32_t kind,
+           const uint8_t* key,
+           uint32_t key_length,
+           const uint8_t* value,
+           uint32_t value_length);
+
+  // Marks an entry as used now; persisted with the next commit.
+  void Touch(uint32_t kind, const uint8_t* key, uint32_t key_length);
+
+  // Writes staged entries and LRU order as a new generation.
+  bool Commit();
+
+  // Removes every entry and the file itself.
+  bool Clear();
+
+ private:
+  struct Entry {
+    uint32_t kind = 0;
+    std::string key;
+    uint64_t last_used_ms = 0;
+    uint64_t stored_at_ms = 0;
+    // Either a staged value or a range in |snapshot_|.
+    bool staged = false;
+    std::vector<uint8_t> value;
+    uint64_t value_offset = 0;
+    uint32_t value_length = 0;
+  };
+
+  FeedCache(std::string path, uint64_t budget_bytes, uint32_t max_pages);
+
+  Entry* FindLocked(uint32_t kind, const uint8_t* key, uint32_t key_length);
+  void EvictLocked();
+  uint64_t FileSizeLocked() const;
+
+  const std::string path_;
+  const uint64_t budget_bytes_;
+  const uint32_t max_pages_;
+
+  std::mutex mutex_;
+  std::vector<Entry> entries_;
+  FeedSnapshot* snapshot_ = nullptr;
+  uint64_t generation_ = 0;
+  bool dirty_ = false;
+};
+
+}  // namespace prava
+
+#endif  // __cplusplus
+
+// C ABI consumed by lib/core/storage/feed_cache.dart and the Linux runner.
+PRAVA_EXPORT void* prava_feed_cache_open(const char* path,
+                                         uint64_t budget_bytes,
+                                         uint32_t max_pages);
+PRAVA_EXPORT void* prava_feed_cache_snapshot(void* cache);
+PRAVA_EXPORT int32_t prava_feed_cache_put(void* cache,
+                                          uint32_t kind,
+                                          const uint8_t* key,
+                                          uint32_t key_length,
+                                          const uint8_t* value,
+                                          uint32_t value_length);
+PRAVA_EXPORT void prava_feed_cache_touch(void* cache,
+                                         uint32_t kind,
+                                         const uint8_t* key,
+                                         uint32_t key_length);
+PRAVA_EXPORT int32_t prava_feed_cache_commit(void* cache);
+PRAVA_EXPORT int32_t prava_feed_cache_clear(void* cache);
+PRAVA_EXPORT void prava_feed_cache_close(void* cache);
+
+// Snapshot accessors. |offset| is relative to prava_feed_snapshot_data().
+PRAVA_EXPORT const uint8_t* prava_feed_snapshot_data(void* snapshot,
+                                                     uint64_t* size);
+PRAVA_EXPORT uint64_t prava_feed_snapshot_generation(void* snapshot);
+PRAVA_EXPORT int32_t prava_feed_snapshot_find(void* snapshot,
+                                              uint32_t kind,
+                                              const uint8_t* key,
+                                              uint32_t key_length,
+                                              uint64_t* offset,
+                                              uint32_t* length);
+// Usable as a NativeFinalizer callback.
+PRAVA_EXPORT void prava_feed_snapshot_release(void* snapshot);
+
+// Starts asynchronous readahead of the cache file so the first Dart read
+// does not wait on disk. Safe to call before the cache is opened.
+PRAVA_EXPORT void prava_feed_cache_prefetch(const char* path);
+
+#endif  // PRAVA_NATIVE_FEED_FEED_CACHE_H_
@@ -0,0 +1,158 @@
+#include "media/media_manifest.h"
+
+#include <fcntl.h>
+#include <sodium.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "common/little_endian.h"
+#include "common/sodium_guard.h"
+#include "common/stopwatch.h"
+#include "common/worker_pool.h"
+
+namespace prava {
+
+namespace {
+
+// Domain tag for the root; bump the version if the chunking scheme changes.
+constexpr char kRootTag[] = "prava-media-v1";
+
+// BLAKE2b-512 truncated to |MediaManifest::kDigestSize|. A full-length
+// BLAKE2b is used (not outlen 32) because that is what Node's crypto module
+// exposes on the backend.
+void Digest(const uint8_t* data, size_t size, uint8_t* out) {
+  uint8_t full[crypto_generichash_BYTES_MAX];
+  crypto_generichash(full, sizeof(full), data, size, nullptr, 0);
+  std::copy(full, full + MediaManifest::kDigestSize, out);
+}
+
+}  // namespace
+
+std::unique_ptr<MediaManifest> MediaManifest::Build(const std::string& path,
+                                                    uint32_t chunk_size) {
+  if (chunk_size < kMinChunkSize || chunk_size > kMaxChunkSize) {
+    return nullptr;
+  }
+  if (!EnsureSodium()) return nullptr;
+
+  Stopwatch total;
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return nullptr;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+  uint64_t size = static_cast<uint64_t>(info.st_size);
+  uint64_t chunk_count = (size + chunk_size - 1) / chunk_size;
+  if (chunk_count > kMaxChunks) {
+    close(fd);
+    return nullptr;
+  }
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) return nullptr;
+  // Every page is read once, front to back within each chunk.
+  madvise(mapped, size, MADV_SEQUENTIAL);
+  madvise(mapped, size, MADV_WILLNEED);
+
+  std::unique_ptr<MediaManifest> manifest(new MediaManifest());
+  manifest->data_ = static_cast<uint8_t*>(mapped);
+  manifest->size_ = size;
+  manifest->chunk_size_ = chunk_size;
+  manifest->chunk_count_ = static_cast<uint32_t>(chunk_count);
+  manifest->digests_.resize(chunk_count * kDigestSize);
+  manifest->timings_.map_ns = total.ElapsedNs();
+
+  // One chunk per task: chunks are at least 64 KiB, far above the cost of
+  // handing work to another core.
+  WorkerPool& pool = WorkerPool::Shared();
+  Stopwatch phase;
+  MediaManifest* m = manifest.get();
+  pool.ParallelFor(chunk_count, 1, [m](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      uint32_t length = 0;
+      const uint8_t* chunk = m->Chunk(static_cast<uint32_t>(i), &length);
+      Digest(chunk, length, m->digests_.data() + i * kDigestSize);
+    }
+  });
+
+  std::vector<uint8_t> preimage(sizeof(kRootTag) - 1 + 12 +
+                                manifest->digests_.size());
+  uint8_t* cursor = std::copy(kRootTag, kRootTag + sizeof(kRootTag) - 1,
+                              preimage.data());
+  WriteU64LE(cursor, size);
+  WriteU32LE(cursor + 8, chunk_size);
+  std::copy(manifest->digests_.begin(), manifest->digests_.end(),
+            cursor + 12);
+  Digest(preimage.data(), preimage.size(), manifest->root_);
+  manifest->timings_.hash_ns = phase.ElapsedNs();
+
+  manifest->timings_.threads =
+      static_cast<uint32_t>(chunk_count > 1 ? pool.concurrency() : 1);
+  manifest->timings_.total_ns = total.ElapsedNs();
+  return manifest;
+}
+
+MediaManifest::~MediaManifest() {
+  if (data_ != nullptr) munmap(data_, size_);
+}
+
+const uint8_t* MediaManifest::Chunk(uint32_t index, uint32_t* length) const {
+  if (index >= chunk_count_) return nullptr;
+  uint64_t offset = static_cast<uint64_t>(index) * chunk_size_;
+  *length = static_cast<uint32_t>(
+      std::min<uint64_t>(chunk_size_, size_ - offset));
+  return data_ + offset;
+}
+
+}  // namespace prava
+
+using prava::MediaManifest;
+
+PRAVA_EXPORT void* prava_media_manifest_build(const char* path,
+                                              uint32_t chunk_size) {
+  if (path == nullptr) return nullptr;
+  return MediaManifest::Build(path, chunk_size).release();
+}
+
+PRAVA_EXPORT uint64_t prava_media_manifest_size(void* manifest) {
+  if (manifest == nullptr) return 0;
+  return static_cast<MediaManifest*>(manifest)->size();
+}
+
+PRAVA_EXPORT uint32_t prava_media_manifest_chunk_count(void* manifest) {
+  if (manifest == nullptr) return 0;
+  return static_cast<MediaManifest*>(manifest)->chunk_count();
+}
+
+PRAVA_EXPORT const uint8_t* prava_media_manifest_root(void* manifest) {
+  if (manifest == nullptr) return nullptr;
+  return static_cast<MediaManifest*>(manifest)->root();
+}
+
+PRAVA_EXPORT const uint8_t* prava_media_manifest_digests(void* manifest) {
+  if (manifest == nullptr) return nullptr;
+  return static_cast<MediaManifest*>(manifest)->digests();
+}
+
+PRAVA_EXPORT const uint8_t* prava_media_manifest_chunk(void* manifest,
+                                                       uint32_t index,
+                                                       uint32_t* length) {
+  if (manifest == nullptr || length == nullptr) return nullptr;
+  return static_cast<MediaManifest*>(manifest)->Chunk(index, length);
+}
+
+PRAVA_EXPORT void prava_media_manifest_timings(
+    void* manifest,
+    PravaMediaManifestTimings* out) {
+  if (manifest == nullptr || out == nullptr) return;
+  *out = static_cast<MediaManifest*>(manifest)->timings();
+}
+
+PRAVA_EXPORT void prava_media_manifest_close(void* manifest) {
+  delete static_cast<MediaManifest*>(manifest);
+}
@@ -0,0 +1,96 @@
+#ifndef PRAVA_NATIVE_MEDIA_MEDIA_MANIFEST_H_
+#define PRAVA_NATIVE_MEDIA_MEDIA_MANIFEST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/export.h"
+
+// Timing counters for one manifest, in nanoseconds.
+typedef struct {
+  uint64_t map_ns;
+  uint64_t hash_ns;
+  uint64_t total_ns;
+  uint32_t threads;
+} PravaMediaManifestTimings;
+
+#ifdef __cplusplus
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace prava {
+
+// Content address of a media file, split into fixed-size upload chunks.
+//
+// The file is mapped read-only and every chunk is hashed in parallel with
+// BLAKE2b-512, keeping the first 32 bytes. The root is computed the same way
+// over
+//   ["prava-media-v1"][file size : u64 LE][chunk size : u32 LE][digests]
+// so the backend can recompute it from the chunks it received (Node's
+// `blake2b512`) and recognize media it already has. The mapping stays alive
+// with the manifest and chunks are handed to Dart without a copy.
+class MediaManifest {
+ public:
+  static constexpr size_t kDigestSize = 32;
+  static constexpr uint32_t kMinChunkSize = 64 * 1024;
+  static constexpr uint32_t kMaxChunkSize = 32 * 1024 * 1024;
+  static constexpr uint32_t kMaxChunks = 65536;
+
+  // Maps and hashes |path|. Returns null if the file is empty or cannot be
+  // read, if |chunk_size| is out of range, or if libsodium is unavailable.
+  static std::unique_ptr<MediaManifest> Build(const std::string& path,
+                                              uint32_t chunk_size);
+
+  ~MediaManifest();
+
+  MediaManifest(const MediaManifest&) = delete;
+  MediaManifest& operator=(const MediaManifest&) = delete;
+
+  uint64_t size() const { return size_; }
+  uint32_t chunk_size() const { return chunk_size_; }
+  uint32_t chunk_count() const { return chunk_count_; }
+  const uint8_t* root() const { return root_; }
+  const uint8_t* digests() const { return digests_.data(); }
+  const PravaMediaManifestTimings& timings() const { return timings_; }
+
+  // Start of chunk |index| in the mapping and its length; null when out of
+  // range.
+  const uint8_t* Chunk(uint32_t index, uint32_t* length) const;
+
+ private:
+  MediaManifest() = default;
+
+  uint8_t* data_ = nullptr;
+  uint64_t size_ = 0;
+  uint32_t chunk_size_ = 0;
+  uint32_t chunk_count_ = 0;
+  std::vector<uint8_t> digests_;
+  uint8_t root_[kDigestSize] = {};
+  PravaMediaManifestTimings timings_ = {};
+};
+
+}  // namespace prava
+
+#endif  // __cplusplus
+
+// C ABI consumed by lib/services/media_manifest.dart.
+PRAVA_EXPORT void* prava_media_manifest_build(const char* path,
+                                              uint32_t chunk_size);
+PRAVA_EXPORT uint64_t prava_media_manifest_size(void* manifest);
+PRAVA_EXPORT uint32_t prava_media_manifest_chunk_count(void* manifest);
+// 32-byte root digest.
+PRAVA_EXPORT const uint8_t* prava_media_manifest_root(void* manifest);
+// |chunk_count| consecutive 32-byte chunk digests.
+PRAVA_EXPORT const uint8_t* prava_media_manifest_digests(void* manifest);
+// Chunk bytes inside the mapping; valid until the manifest is closed.
+PRAVA_EXPORT const uint8_t* prava_media_manifest_chunk(void* manifest,
+                                                       uint32_t index,
+                                                       uint32_t* length);
+PRAVA_EXPORT void prava_media_manifest_timings(
+    void* manifest,
+    PravaMediaManifestTimings* out);
+PRAVA_EXPORT void prava_media_manifest_close(void* manifest);
+
+#endif  // PRAVA_NATIVE_MEDIA_MEDIA_MANIFEST_H_
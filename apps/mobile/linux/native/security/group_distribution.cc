@@ -0,0 +1,108 @@
+#include "security/group_distribution.h"
+
+#include <sodium.h>
+
+#include <atomic>
+#include <cstring>
+
+#include "common/sodium_guard.h"
+#include "common/stopwatch.h"
+#include "common/worker_pool.h"
+
+namespace prava {
+
+namespace {
+
+// Devices per ParallelFor chunk. Sealing a distribution payload is a few
+// microseconds, so chunks are sized to amortize the hand-off.
+constexpr size_t kSealGrain = 32;
+
+}  // namespace
+
+std::unique_ptr<DistributionBatch> DistributionBatch::Seal(
+    const uint8_t* plaintext,
+    uint32_t plaintext_length,
+    const uint8_t* steps,
+    uint32_t count) {
+  if (count == 0 || count > kMaxDevices || steps == nullptr ||
+      plaintext_length > kMaxPlaintext ||
+      (plaintext == nullptr && plaintext_length > 0)) {
+    return nullptr;
+  }
+  if (!EnsureSodium()) return nullptr;
+
+  Stopwatch total;
+  const size_t raw_size = kHeaderSize + kMacSize + plaintext_length;
+  const size_t stride =
+      sodium_base64_ENCODED_LEN(raw_size, sodium_base64_VARIANT_ORIGINAL);
+
+  std::unique_ptr<DistributionBatch> batch(new DistributionBatch());
+  batch->count_ = count;
+  batch->stride_ = static_cast<uint32_t>(stride);
+  batch->arena_ = BufferPool::Shared().Acquire(stride * count);
+  char* out = reinterpret_cast<char*>(batch->arena_.data());
+
+  WorkerPool& pool = WorkerPool::Shared();
+  std::atomic<bool> failed{false};
+  Stopwatch seal;
+  pool.ParallelFor(count, kSealGrain, [&](size_t begin, size_t end) {
+    // One scratch message per chunk, reused for every device in it.
+    BufferPool::Lease scratch = BufferPool::Shared().Acquire(raw_size);
+    uint8_t* raw = scratch.data();
+    uint8_t* nonce = raw + kKeySize + 8;
+    for (size_t i = begin; i < end; ++i) {
+      const uint8_t* step = steps + i * kStepSize;
+      const uint8_t* message_key = step;
+      // Header: ratchet public key + both counters, already big-endian.
+      std::memcpy(raw, step + kKeySize, kKeySize + 8);
+      randombytes_buf(nonce, kNonceSize);
+      if (crypto_secretbox_easy(raw + kHeaderSize, plaintext,
+                                plaintext_length, nonce, message_key) != 0) {
+        failed.store(true, std::memory_order_relaxed);
+        continue;
+      }
+      sodium_bin2base64(out + i * stride, stride, raw, raw_size,
+                        sodium_base64_VARIANT_ORIGINAL);
+    }
+  });
+  batch->timings_.seal_ns = seal.ElapsedNs();
+  if (failed.load()) return nullptr;
+
+  batch->timings_.threads =
+      static_cast<uint32_t>(count > kSealGrain ? pool.concurrency() : 1);
+  batch->timings_.total_ns = total.ElapsedNs();
+  return batch;
+}
+
+}  // namespace prava
+
+using prava::DistributionBatch;
+
+PRAVA_EXPORT void* prava_distribution_seal(const uint8_t* plaintext,
+                                           uint32_t plaintext_length,
+                                           const uint8_t* steps,
+                                           uint32_t count) {
+  return DistributionBatch::Seal(plaintext, plaintext_length, steps, count)
+      .release();
+}
+
+PRAVA_EXPORT const char* prava_distribution_envelopes(const void* batch,
+                                                      uint32_t* stride) {
+  const auto* distribution = static_cast<const DistributionBatch*>(batch);
+  if (stride != nullptr) *stride = distribution ? distribution->stride() : 0;
+  return distribution ? distribution->envelopes() : nullptr;
+}
+
+PRAVA_EXPORT void prava_distribution_timings(const void* batch,
+                                             PravaDistributionTimings* out) {
+  if (out == nullptr) return;
+  if (batch == nullptr) {
+    std::memset(out, 0, sizeof(*out));
+    return;
+  }
+  *out = static_cast<const DistributionBatch*>(batch)->timings();
+}
+
+PRAVA_EXPORT void prava_distribution_free(void* batch) {
+  delete static_cast<DistributionBatch*>(batch);
+}
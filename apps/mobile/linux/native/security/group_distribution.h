@@ -0,0 +1,90 @@
+#ifndef PRAVA_NATIVE_SECURITY_GROUP_DISTRIBUTION_H_
+#define PRAVA_NATIVE_SECURITY_GROUP_DISTRIBUTION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/export.h"
+
+// Timing counters for one distribution batch, in nanoseconds.
+typedef struct {
+  uint64_t seal_ns;
+  uint64_t total_ns;
+  uint32_t threads;
+} PravaDistributionTimings;
+
+#ifdef __cplusplus
+
+#include <memory>
+
+#include "common/buffer_pool.h"
+
+namespace prava {
+
+// Seals one plaintext (a sender-key distribution payload) for many device
+// sessions at once.
+//
+// The caller advances each pairwise Double Ratchet sending chain and passes
+// one packed step per device:
+//   [message key : 32][ratchet public key : 32]
+//   [message number : u32 BE][previous chain length : u32 BE]
+// For every step the kernel draws a nonce, seals the plaintext with
+// crypto_secretbox (XSalsa20-Poly1305, as MessageKeys.encrypt does) and
+// writes the base64 of RatchetMessage.toBytes(). Devices are processed in
+// parallel into one pooled output arena of fixed-stride, NUL-terminated
+// strings, so results can be handed to Dart in a single batch.
+class DistributionBatch {
+  static constexpr size_t kKeySize = 32;
+  static constexpr size_t kNonceSize = 24;
+  static constexpr size_t kMacSize = 16;
+
+ public:
+  static constexpr size_t kStepSize = kKeySize + kKeySize + 4 + 4;
+  static constexpr size_t kHeaderSize = kKeySize + 4 + 4 + kNonceSize;
+  static constexpr uint32_t kMaxDevices = 10000;
+  static constexpr uint32_t kMaxPlaintext = 256 * 1024;
+
+  // Returns null on invalid arguments or if libsodium is unavailable.
+  static std::unique_ptr<DistributionBatch> Seal(const uint8_t* plaintext,
+                                                 uint32_t plaintext_length,
+                                                 const uint8_t* steps,
+                                                 uint32_t count);
+
+  DistributionBatch(const DistributionBatch&) = delete;
+  DistributionBatch& operator=(const DistributionBatch&) = delete;
+
+  uint32_t count() const { return count_; }
+  // Distance between consecutive envelopes, including the NUL terminator.
+  uint32_t stride() const { return stride_; }
+  const char* envelopes() const {
+    return reinterpret_cast<const char*>(arena_.data());
+  }
+  const PravaDistributionTimings& timings() const { return timings_; }
+
+ private:
+  DistributionBatch() = default;
+
+  uint32_t count_ = 0;
+  uint32_t stride_ = 0;
+  BufferPool::Lease arena_;
+  PravaDistributionTimings timings_ = {};
+};
+
+}  // namespace prava
+
+#endif  // __cplusplus
+
+// C ABI consumed by lib/security/bridge/native_group_distribution.dart.
+// Envelope i starts at envelopes + i * stride and is stride - 1 characters
+// long.
+PRAVA_EXPORT void* prava_distribution_seal(const uint8_t* plaintext,
+                                           uint32_t plaintext_length,
+                                           const uint8_t* steps,
+                                           uint32_t count);
+PRAVA_EXPORT const char* prava_distribution_envelopes(const void* batch,
+                                                      uint32_t* stride);
+PRAVA_EXPORT void prava_distribution_timings(const void* batch,
+                                             PravaDistributionTimings* out);
+PRAVA_EXPORT void prava_distribution_free(void* batch);
+
+#endif  // PRAVA_NATIVE_SECURITY_GROUP_DISTRIBUTION_H_
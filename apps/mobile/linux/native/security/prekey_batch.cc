@@ -0,0 +1,181 @@
+#include "security/prekey_batch.h"
+
+#include <sodium.h>
+
+#include <atomic>
+#include <cstring>
+
+#include "common/sodium_guard.h"
+#include "common/stopwatch.h"
+#include "common/worker_pool.h"
+
+namespace prava {
+
+namespace {
+
+// Keys per ParallelFor chunk. X25519 keygen is ~50us, so this keeps chunks
+// well above the cost of handing work to another core.
+constexpr size_t kKeygenGrain = 16;
+
+void WriteKeyId(uint8_t* out, uint32_t key_id) {
+  out[0] = static_cast<uint8_t>(key_id);
+  out[1] = static_cast<uint8_t>(key_id >> 8);
+  out[2] = static_cast<uint8_t>(key_id >> 16);
+  out[3] = static_cast<uint8_t>(key_id >> 24);
+}
+
+}  // namespace
+
+std::unique_ptr<PrekeyBatch> PrekeyBatch::Generate(
+    uint32_t start_id,
+    uint32_t count,
+    const uint8_t* identity_secret_key,
+    uint32_t signed_key_id) {
+  if (count > kMaxCount || start_id == 0 ||
+      static_cast<uint64_t>(start_id) + count > UINT32_MAX) {
+    return nullptr;
+  }
+  if (count == 0 && signed_key_id == 0) return nullptr;
+  if (signed_key_id != 0 && identity_secret_key == nullptr) return nullptr;
+  if (!EnsureSodium()) return nullptr;
+
+  Stopwatch total;
+  std::unique_ptr<PrekeyBatch> batch(new PrekeyBatch());
+  batch->start_id_ = start_id;
+  batch->count_ = count;
+
+  if (count > 0) {
+    batch->records_ =
+        static_cast<uint8_t*>(sodium_malloc(count * kRecordSize));
+    if (batch->records_ == nullptr) return nullptr;
+  }
+  if (signed_key_id != 0) {
+    batch->signed_record_ =
+        static_cast<uint8_t*>(sodium_malloc(kSignedRecordSize));
+    if (batch->signed_record_ == nullptr) return nullptr;
+  }
+
+  WorkerPool& pool = WorkerPool::Shared();
+  std::atomic<bool> failed{false};
+  Stopwatch phase;
+  pool.ParallelFor(count, kKeygenGrain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      uint8_t* record = batch->records_ + i * kRecordSize;
+      WriteKeyId(record, start_id + static_cast<uint32_t>(i));
+      if (crypto_box_keypair(record + 4, record + 4 + kPublicKeySize) != 0) {
+        failed.store(true, std::memory_order_relaxed);
+      }
+    }
+  });
+  batch->timings_.keygen_ns = phase.LapNs();
+  if (failed.load()) return nullptr;
+
+  if (signed_key_id != 0) {
+    uint8_t* record = batch->signed_record_;
+    WriteKeyId(record, signed_key_id);
+    uint8_t* public_key = record + 4;
+    uint8_t* signature = record + kRecordSize;
+    if (crypto_box_keypair(public_key, public_key + kPublicKeySize) != 0 ||
+        crypto_sign_detached(signature, nullptr, public_key, kPublicKeySize,
+                             identity_secret_key) != 0) {
+      return nullptr;
+    }
+  }
+  batch->timings_.sign_ns = phase.LapNs();
+
+  batch->SerializeUploadJson();
+  batch->timings_.serialize_ns = phase.LapNs();
+
+  batch->timings_.threads = static_cast<uint32_t>(
+      count > kKeygenGrain ? pool.concurrency() : 1);
+  batch->timings_.total_ns = total.ElapsedNs();
+  return batch;
+}
+
+PrekeyBatch::~PrekeyBatch() {
+  // sodium_free zeroes the region before unmapping it.
+  if (records_ != nullptr) sodium_free(records_);
+  if (signed_record_ != nullptr) sodium_free(signed_record_);
+}
+
+void PrekeyBatch::SerializeUploadJson() {
+  static constexpr char kKeyIdField[] = "{\"keyId\":";
+  static constexpr char kPublicKeyField[] = ",\"publicKey\":\"";
+  constexpr size_t kBase64Size =
+      sodium_base64_ENCODED_LEN(kPublicKeySize, sodium_base64_VARIANT_ORIGINAL);
+  // Fixed text + up to 10 id digits + base64 (incl. NUL) + closing quote,
+  // brace and separator.
+  constexpr size_t kEntryBound =
+      sizeof(kKeyIdField) + sizeof(kPublicKeyField) + 10 + kBase64Size + 3;
+
+  upload_json_.clear();
+  upload_json_.reserve(2 + count_ * kEntryBound);
+  upload_json_.push_back('[');
+  char base64[kBase64Size];
+  for (uint32_t i = 0; i < count_; ++i) {
+    const uint8_t* public_key = records_ + i * kRecordSize + 4;
+    sodium_bin2base64(base64, sizeof(base64), public_key, kPublicKeySize,
+                      sodium_base64_VARIANT_ORIGINAL);
+    if (i > 0) upload_json_.push_back(',');
+    upload_json_.append(kKeyIdField);
+    upload_json_.append(std::to_string(start_id_ + i));
+    upload_json_.append(kPublicKeyField);
+    upload_json_.append(base64);
+    upload_json_.append("\"}");
+  }
+  upload_json_.push_back(']');
+}
+
+}  // namespace prava
+
+using prava::PrekeyBatch;
+
+PRAVA_EXPORT void* prava_prekey_batch_generate(
+    uint32_t start_id,
+    uint32_t count,
+    const uint8_t* identity_secret_key,
+    uint32_t signed_key_id) {
+  return PrekeyBatch::Generate(start_id, count, identity_secret_key,
+                               signed_key_id)
+      .release();
+}
+
+PRAVA_EXPORT uint32_t prava_prekey_batch_count(const void* batch) {
+  return batch ? static_cast<const PrekeyBatch*>(batch)->count() : 0;
+}
+
+PRAVA_EXPORT const uint8_t* prava_prekey_batch_records(const void* batch) {
+  return batch ? static_cast<const PrekeyBatch*>(batch)->records() : nullptr;
+}
+
+PRAVA_EXPORT const uint8_t* prava_prekey_batch_signed_record(
+    const void* batch) {
+  return batch ? static_cast<const PrekeyBatch*>(batch)->signed_record()
+               : nullptr;
+}
+
+PRAVA_EXPORT const char* prava_prekey_batch_upload_json(const void* batch,
+                                                        uint32_t* length) {
+  if (batch == nullptr) {
+    if (length != nullptr) *length = 0;
+    return nullptr;
+  }
+  const std::string& json =
+      static_cast<const PrekeyBatch*>(batch)->upload_json();
+  if (length != nullptr) *length = static_cast<uint32_t>(json.size());
+  return json.c_str();
+}
+
+PRAVA_EXPORT void prava_prekey_batch_timings(const void* batch,
+                                             PravaPrekeyBatchTimings* out) {
+  if (out == nullptr) return;
+  if (batch == nullptr) {
+    std::memset(out, 0, sizeof(*out));
+    return;
+  }
+  *out = static_cast<const PrekeyBatch*>(batch)->timings();
+}
+
+PRAVA_EXPORT void prava_prekey_batch_free(void* batch) {
+  delete static_cast<PrekeyBatch*>(batch);
+}
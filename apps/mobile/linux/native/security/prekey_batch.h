@@ -0,0 +1,99 @@
+#ifndef PRAVA_NATIVE_SECURITY_PREKEY_BATCH_H_
+#define PRAVA_NATIVE_SECURITY_PREKEY_BATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/export.h"
+
+// Timing counters for one batch, in nanoseconds.
+typedef struct {
+  uint64_t keygen_ns;
+  uint64_t sign_ns;
+  uint64_t serialize_ns;
+  uint64_t total_ns;
+  uint32_t threads;
+} PravaPrekeyBatchTimings;
+
+#ifdef __cplusplus
+
+#include <memory>
+#include <string>
+
+namespace prava {
+
+// A batch of freshly generated one-time prekeys, plus an optional signed
+// prekey, held in guarded (mlocked, zeroed-on-free) memory.
+//
+// One-time prekeys are packed as fixed-size records
+//   [key id : u32 LE][X25519 public : 32][X25519 secret : 32]
+// so Dart can read them straight into PreKeyData without per-key calls. The
+// signed prekey record appends the 64-byte Ed25519 signature over the public
+// key. The public halves are also serialized into the `oneTimePreKeys` JSON
+// array used by /crypto/devices/register and /crypto/prekeys.
+class PrekeyBatch {
+ public:
+  static constexpr size_t kPublicKeySize = 32;
+  static constexpr size_t kSecretKeySize = 32;
+  static constexpr size_t kSignatureSize = 64;
+  static constexpr size_t kIdentitySecretKeySize = 64;
+  static constexpr size_t kRecordSize = 4 + kPublicKeySize + kSecretKeySize;
+  static constexpr size_t kSignedRecordSize = kRecordSize + kSignatureSize;
+  static constexpr uint32_t kMaxCount = 1000;
+
+  // Generates |count| one-time prekeys with ids starting at |start_id|. When
+  // |signed_key_id| is non-zero a signed prekey with that id is generated and
+  // signed with |identity_secret_key| (Ed25519, 64 bytes). Returns null on
+  // invalid arguments or if libsodium is unavailable.
+  static std::unique_ptr<PrekeyBatch> Generate(
+      uint32_t start_id,
+      uint32_t count,
+      const uint8_t* identity_secret_key,
+      uint32_t signed_key_id);
+
+  ~PrekeyBatch();
+
+  PrekeyBatch(const PrekeyBatch&) = delete;
+  PrekeyBatch& operator=(const PrekeyBatch&) = delete;
+
+  uint32_t count() const { return count_; }
+  const uint8_t* records() const { return records_; }
+  const uint8_t* signed_record() const { return signed_record_; }
+  const std::string& upload_json() const { return upload_json_; }
+  const PravaPrekeyBatchTimings& timings() const { return timings_; }
+
+ private:
+  PrekeyBatch() = default;
+
+  void SerializeUploadJson();
+
+  uint32_t start_id_ = 0;
+  uint32_t count_ = 0;
+  uint8_t* records_ = nullptr;
+  uint8_t* signed_record_ = nullptr;
+  std::string upload_json_;
+  PravaPrekeyBatchTimings timings_ = {};
+};
+
+}  // namespace prava
+
+#endif  // __cplusplus
+
+// C ABI consumed by lib/security/bridge/native_prekeys.dart. Batches are
+// opaque handles; every pointer returned stays valid until the batch is
+// freed, which also wipes the secret keys.
+PRAVA_EXPORT void* prava_prekey_batch_generate(
+    uint32_t start_id,
+    uint32_t count,
+    const uint8_t* identity_secret_key,
+    uint32_t signed_key_id);
+PRAVA_EXPORT uint32_t prava_prekey_batch_count(const void* batch);
+PRAVA_EXPORT const uint8_t* prava_prekey_batch_records(const void* batch);
+PRAVA_EXPORT const uint8_t* prava_prekey_batch_signed_record(const void* batch);
+PRAVA_EXPORT const char* prava_prekey_batch_upload_json(const void* batch,
+                                                        uint32_t* length);
+PRAVA_EXPORT void prava_prekey_batch_timings(const void* batch,
+                                             PravaPrekeyBatchTimings* out);
+PRAVA_EXPORT void prava_prekey_batch_free(void* batch);
+
+#endif  // PRAVA_NATIVE_SECURITY_PREKEY_BATCH_H_
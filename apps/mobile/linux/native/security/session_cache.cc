@@ -0,0 +1,671 @@
+#include "security/session_cache.h"
+
+#include <fcntl.h>
+#include <sodium.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "common/little_endian.h"
+#include "common/secure_buffer.h"
+#include "common/sodium_guard.h"
+
+namespace prava {
+
+namespace {
+
+// Journal record layout (little endian):
+//   [magic : u32][type : u8][reserved : 3][key length : u32]
+//   [value length : u32][sequence : u64][key][value][BLAKE2b-128 : 16]
+// The checksum covers everything before it, so a record cut short by a
+// crash or a torn page fails verification and ends the replay.
+constexpr uint32_t kRecordMagic = 0x31435350;  // "PSC1"
+constexpr size_t kHeaderSize = 24;
+constexpr size_t kChecksumSize = 16;
+constexpr uint8_t kRecordPut = 1;
+constexpr uint8_t kRecordRemove = 2;
+
+// Session ids are short; records hold a few KB of keys and skipped-key JSON.
+// Anything larger than this is treated as corruption during replay.
+constexpr uint32_t kMaxKeySize = 1024;
+constexpr uint32_t kMaxValueSize = 4 * 1024 * 1024;
+
+// Values grow in place inside an allocation of at least this size.
+constexpr uint32_t kMinValueCapacity = 256;
+
+uint32_t RoundCapacity(uint32_t length) {
+  uint32_t capacity = kMinValueCapacity;
+  while (capacity < length) capacity <<= 1;
+  return capacity;
+}
+
+bool WriteAll(int fd, const uint8_t* data, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+bool ReadAll(int fd, uint8_t* data, size_t size) {
+  while (size > 0) {
+    ssize_t got = read(fd, data, size);
+    if (got < 0 && errno == EINTR) continue;
+    if (got <= 0) return false;
+    data += got;
+    size -= static_cast<size_t>(got);
+  }
+  return true;
+}
+
+int OpenJournal(const std::string& path) {
+  return open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+}
+
+// Makes a rename inside |path|'s directory durable.
+void SyncParentDirectory(const std::string& path) {
+  size_t slash = path.rfind('/');
+  std::string directory =
+      slash == std::string::npos ? "." : path.substr(0, slash);
+  int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) return;
+  fsync(fd);
+  close(fd);
+}
+
+size_t RecordSize(size_t key_length, size_t value_length) {
+  return kHeaderSize + key_length + value_length + kChecksumSize;
+}
+
+// Encodes one record into |out|, which must hold RecordSize() bytes.
+void EncodeRecord(uint8_t* out,
+                  uint8_t type,
+                  const std::string& key,
+                  const uint8_t* value,
+                  uint32_t length,
+                  uint64_t sequence) {
+  std::memset(out, 0, kHeaderSize);
+  WriteU32LE(out, kRecordMagic);
+  out[4] = type;
+  WriteU32LE(out + 8, static_cast<uint32_t>(key.size()));
+  WriteU32LE(out + 12, length);
+  WriteU64LE(out + 16, sequence);
+  std::memcpy(out + kHeaderSize, key.data(), key.size());
+  if (length > 0) std::memcpy(out + kHeaderSize + key.size(), value, length);
+  size_t body = kHeaderSize + key.size() + length;
+  crypto_generichash(out + body, kChecksumSize, out, body, nullptr, 0);
+}
+
+}  // namespace
+
+struct SessionCache::Entry {
+  // sodium_malloc allocation of |capacity| bytes; the first |length| hold
+  // the record.
+  uint8_t* data = nullptr;
+  uint32_t length = 0;
+  uint32_t capacity = 0;
+  // Sequence of the newest unflushed write, or 0 when Isar is up to date.
+  uint64_t dirty_sequence = 0;
+  LruList::iterator lru;
+};
+
+std::unique_ptr<SessionCache> SessionCache::Open(
+    const std::string& journal_path,
+    uint32_t capacity,
+    uint32_t sync_interval_ms) {
+  if (journal_path.empty() || capacity == 0) return nullptr;
+  if (!EnsureSodium()) return nullptr;
+
+  std::unique_ptr<SessionCache> cache(
+      new SessionCache(journal_path, capacity, sync_interval_ms));
+  if (!cache->Recover()) return nullptr;
+  cache->journal_fd_ = OpenJournal(journal_path);
+  if (cache->journal_fd_ < 0) return nullptr;
+  cache->sync_thread_ = std::thread(&SessionCache::SyncLoop, cache.get());
+  return cache;
+}
+
+SessionCache::SessionCache(std::string journal_path,
+                           uint32_t capacity,
+                           uint32_t sync_interval_ms)
+    : journal_path_(std::move(journal_path)),
+      capacity_(capacity),
+      sync_interval_ms_(sync_interval_ms) {}
+
+SessionCache::~SessionCache() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  sync_wake_.notify_all();
+  if (sync_thread_.joinable()) sync_thread_.join();
+
+  if (journal_fd_ >= 0) {
+    if (unsynced_bytes_ > 0) fdatasync(journal_fd_);
+    close(journal_fd_);
+  }
+  for (auto& item : entries_) sodium_free(item.second.data);
+}
+
+bool SessionCache::Recover() {
+  int fd = open(journal_path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return errno == ENOENT;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return false;
+  }
+  size_t size = static_cast<size_t>(info.st_size);
+  SecureBuffer journal;
+  bool read_ok =
+      journal.Resize(size) && (size == 0 || ReadAll(fd, journal.data(), size));
+  close(fd);
+  if (!read_ok) return false;
+
+  const uint8_t* data = journal.data();
+  size_t offset = 0;
+  uint8_t checksum[kChecksumSize];
+  while (size - offset >= kHeaderSize + kChecksumSize) {
+    const uint8_t* record = data + offset;
+    uint32_t key_length = ReadU32LE(record + 8);
+    uint32_t value_length = ReadU32LE(record + 12);
+    uint8_t type = record[4];
+    if (ReadU32LE(record) != kRecordMagic || key_length == 0 ||
+        key_length > kMaxKeySize || value_length > kMaxValueSize ||
+        (type != kRecordPut && type != kRecordRemove)) {
+      break;
+    }
+    size_t record_size = RecordSize(key_length, value_length);
+    if (size - offset < record_size) break;
+    size_t body = record_size - kChecksumSize;
+    crypto_generichash(checksum, kChecksumSize, record, body, nullptr, 0);
+    if (sodium_memcmp(checksum, record + body, kChecksumSize) != 0) break;
+
+    std::string key(reinterpret_cast<const char*>(record + kHeaderSize),
+                    key_length);
+    if (type == kRecordPut) {
+      if (!StoreLocked(key, record + kHeaderSize + key_length, value_length,
+                       ++sequence_)) {
+        return false;
+      }
+    } else {
+      EraseLocked(key);
+    }
+    offset += record_size;
+  }
+
+  // Drop whatever follows the last intact record so new appends are not
+  // stranded behind garbage on the next replay.
+  if (offset < size && truncate(journal_path_.c_str(),
+                                static_cast<off_t>(offset)) != 0) {
+    return false;
+  }
+  stats_.journal_bytes = offset;
+  EvictLocked();
+  return true;
+}
+
+int SessionCache::Get(const std::string& key,
+                      uint8_t* out,
+                      uint32_t out_capacity,
+                      uint32_t* length) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = entries_.find(key);
+  if (found == entries_.end()) {
+    ++stats_.misses;
+    return 0;
+  }
+  Entry& entry = found->second;
+  *length = entry.length;
+  if (entry.length > out_capacity) return -1;
+
+  ++stats_.hits;
+  std::memcpy(out, entry.data, entry.length);
+  lru_.splice(lru_.begin(), lru_, entry.lru);
+  return 1;
+}
+
+bool SessionCache::Put(const std::string& key,
+                       const uint8_t* value,
+                       uint32_t length) {
+  if (key.empty() || key.size() > kMaxKeySize || length > kMaxValueSize) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t sequence = ++sequence_;
+  if (!StoreLocked(key, value, length, sequence)) return false;
+  ++stats_.puts;
+  EvictLocked();
+  // The cached copy stays authoritative even if the append fails: the caller
+  // flushes it to Isar right away, and AppendRecord has scheduled a
+  // compaction that rewrites the journal from the cache.
+  return AppendRecord(kRecordPut, key, value, length, sequence);
+}
+
+bool SessionCache::Prime(const std::string& key,
+                         const uint8_t* value,
+                         uint32_t length) {
+  if (key.empty() || key.size() > kMaxKeySize || length > kMaxValueSize) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.count(key) != 0) return true;
+  if (!StoreLocked(key, value, length, 0)) return false;
+  EvictLocked();
+  return true;
+}
+
+bool SessionCache::Remove(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  EraseLocked(key);
+  // Without the tombstone the key's earlier puts would come back on replay;
+  // the compaction a failed append schedules rewrites the journal without
+  // them.
+  return AppendRecord(kRecordRemove, key, nullptr, 0, ++sequence_);
+}
+
+bool SessionCache::Clear() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto& item : entries_) sodium_free(item.second.data);
+  entries_.clear();
+  lru_.clear();
+  ++journal_epoch_;
+  compaction_tail_.Clear();
+  if (ftruncate(journal_fd_, 0) != 0) return false;
+  unsynced_bytes_ = 0;
+  stats_.journal_bytes = 0;
+  journal_torn_ = false;
+  journal_stale_ = false;
+
+  // Make the truncation durable without holding up other callers.
+  int fd = dup(journal_fd_);
+  lock.unlock();
+  bool synced = fd >= 0 && fdatasync(fd) == 0;
+  if (fd >= 0) close(fd);
+  return synced;
+}
+
+uint64_t SessionCache::TakeDirty(uint8_t** out,
+                                 size_t* out_size,
+                                 uint32_t* count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *out = nullptr;
+  *out_size = 0;
+  *count = 0;
+
+  size_t total = 0;
+  uint32_t dirty = 0;
+  for (const auto& item : entries_) {
+    if (item.second.dirty_sequence == 0) continue;
+    total += 8 + item.first.size() + item.second.length;
+    ++dirty;
+  }
+  if (dirty == 0) return sequence_;
+
+  uint8_t* buffer = static_cast<uint8_t*>(sodium_malloc(total));
+  if (buffer == nullptr) return 0;
+  uint8_t* cursor = buffer;
+  for (const auto& item : entries_) {
+    const Entry& entry = item.second;
+    if (entry.dirty_sequence == 0) continue;
+    WriteU32LE(cursor, static_cast<uint32_t>(item.first.size()));
+    std::memcpy(cursor + 4, item.first.data(), item.first.size());
+    cursor += 4 + item.first.size();
+    WriteU32LE(cursor, entry.length);
+    std::memcpy(cursor + 4, entry.data, entry.length);
+    cursor += 4 + entry.length;
+  }
+
+  *out = buffer;
+  *out_size = total;
+  *count = dirty;
+  return sequence_;
+}
+
+bool SessionCache::Checkpoint(uint64_t generation) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& item : entries_) {
+    if (item.second.dirty_sequence <= generation) {
+      item.second.dirty_sequence = 0;
+    }
+  }
+  ++stats_.checkpoints;
+  EvictLocked();
+  // A stale journal is retried here too, so a compaction that failed (say,
+  // on a full disk) does not spin on the sync thread.
+  if ((journal_stale_ || stats_.journal_bytes >= kCompactThreshold) &&
+      !compact_requested_) {
+    compact_requested_ = true;
+    sync_wake_.notify_all();
+  }
+  return true;
+}
+
+PravaSessionCacheStats SessionCache::Stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PravaSessionCacheStats stats = stats_;
+  stats.entries = static_cast<uint32_t>(entries_.size());
+  stats.dirty = 0;
+  for (const auto& item : entries_) {
+    if (item.second.dirty_sequence != 0) ++stats.dirty;
+  }
+  return stats;
+}
+
+bool SessionCache::AppendRecord(uint8_t type,
+                                const std::string& key,
+                                const uint8_t* value,
+                                uint32_t length,
+                                uint64_t sequence) {
+  // Replay stops at the first bad record, so nothing may be appended behind
+  // the remains of a failed write: cut them off first.
+  if (journal_torn_) {
+    if (ftruncate(journal_fd_, static_cast<off_t>(stats_.journal_bytes)) !=
+        0) {
+      return false;
+    }
+    journal_torn_ = false;
+  }
+
+  size_t size = RecordSize(key.size(), length);
+  if (!record_scratch_.Resize(size)) {
+    MarkJournalStaleLocked();
+    return false;
+  }
+  EncodeRecord(record_scratch_.data(), type, key, value, length, sequence);
+  bool written = WriteAll(journal_fd_, record_scratch_.data(), size);
+  if (written && compacting_ &&
+      !compaction_tail_.Append(record_scratch_.data(), size)) {
+    // The compaction cannot carry this record over; MarkJournalStaleLocked
+    // discards it and schedules another.
+    MarkJournalStaleLocked();
+  }
+  record_scratch_.Clear();
+  if (!written) {
+    // A short write (ENOSPC) leaves part of a record at the end; roll back
+    // to the last good one, or retry on the next append.
+    journal_torn_ =
+        ftruncate(journal_fd_, static_cast<off_t>(stats_.journal_bytes)) != 0;
+    MarkJournalStaleLocked();
+    return false;
+  }
+
+  stats_.journal_bytes += size;
+  unsynced_bytes_ += size;
+  if (sync_interval_ms_ == 0) {
+    if (fdatasync(journal_fd_) != 0) return false;
+    unsynced_bytes_ = 0;
+    ++stats_.journal_syncs;
+  } else {
+    sync_wake_.notify_one();
+  }
+  return true;
+}
+
+bool SessionCache::StoreLocked(const std::string& key,
+                               const uint8_t* value,
+                               uint32_t length,
+                               uint64_t dirty_sequence) {
+  auto found = entries_.find(key);
+  if (found == entries_.end()) {
+    Entry entry;
+    entry.capacity = RoundCapacity(length);
+    entry.data = static_cast<uint8_t*>(sodium_malloc(entry.capacity));
+    if (entry.data == nullptr) return false;
+    lru_.push_front(key);
+    entry.lru = lru_.begin();
+    found = entries_.emplace(key, entry).first;
+  } else {
+    lru_.splice(lru_.begin(), lru_, found->second.lru);
+  }
+
+  Entry& entry = found->second;
+  if (length > entry.capacity) {
+    uint32_t capacity = RoundCapacity(length);
+    uint8_t* data = static_cast<uint8_t*>(sodium_malloc(capacity));
+    if (data == nullptr) {
+      EraseLocked(key);
+      return false;
+    }
+    sodium_free(entry.data);
+    entry.data = data;
+    entry.capacity = capacity;
+  } else if (length < entry.length) {
+    sodium_memzero(entry.data + length, entry.length - length);
+  }
+  if (length > 0) std::memcpy(entry.data, value, length);
+  entry.length = length;
+  entry.dirty_sequence = dirty_sequence;
+  return true;
+}
+
+void SessionCache::MarkJournalStaleLocked() {
+  journal_stale_ = true;
+  // An in-flight compaction copied the cache before this change; drop it.
+  ++journal_epoch_;
+  if (!compact_requested_) {
+    compact_requested_ = true;
+    sync_wake_.notify_all();
+  }
+}
+
+void SessionCache::EraseLocked(const std::string& key) {
+  auto found = entries_.find(key);
+  if (found == entries_.end()) return;
+  sodium_free(found->second.data);
+  lru_.erase(found->second.lru);
+  entries_.erase(found);
+}
+
+void SessionCache::EvictLocked() {
+  auto cursor = lru_.end();
+  while (entries_.size() > capacity_ && cursor != lru_.begin()) {
+    --cursor;
+    auto found = entries_.find(*cursor);
+    if (found->second.dirty_sequence != 0) continue;
+    auto next = std::next(cursor);
+    sodium_free(found->second.data);
+    entries_.erase(found);
+    lru_.erase(cursor);
+    cursor = next;
+    ++stats_.evictions;
+  }
+}
+
+void SessionCache::CompactJournal(std::unique_lock<std::mutex>* lock) {
+  compact_requested_ = false;
+  const uint64_t epoch = journal_epoch_;
+
+  size_t total = 0;
+  for (const auto& item : entries_) {
+    if (item.second.dirty_sequence == 0) continue;
+    total += RecordSize(item.first.size(), item.second.length);
+  }
+  SecureBuffer buffer;
+  if (!buffer.Resize(total)) return;
+  uint8_t* cursor = buffer.data();
+  for (const auto& item : entries_) {
+    const Entry& entry = item.second;
+    if (entry.dirty_sequence == 0) continue;
+    EncodeRecord(cursor, kRecordPut, item.first, entry.data, entry.length,
+                 entry.dirty_sequence);
+    cursor += RecordSize(item.first.size(), entry.length);
+  }
+  compacting_ = true;
+  compaction_tail_.Clear();
+  lock->unlock();
+
+  // Still-dirty records go to a fresh file that atomically replaces the
+  // journal, so a crash mid-compaction leaves either file intact.
+  std::string temp_path = journal_path_ + ".tmp";
+  int fd = open(temp_path.c_str(),
+                O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0600);
+  bool ok = fd >= 0 && WriteAll(fd, buffer.data(), total) &&
+            fdatasync(fd) == 0;
+  lock->lock();
+  // Copy over whatever was appended meanwhile until nothing is left; the
+  // lock is held from the last (empty) check through the swap, so no record
+  // can land in the old journal only.
+  while (ok && epoch == journal_epoch_ && !compaction_tail_.empty()) {
+    SecureBuffer tail = std::move(compaction_tail_);
+    lock->unlock();
+    ok = WriteAll(fd, tail.data(), tail.size()) && fdatasync(fd) == 0;
+    total += tail.size();
+    lock->lock();
+  }
+  compacting_ = false;
+  compaction_tail_.Clear();
+
+  if (!ok || epoch != journal_epoch_ ||
+      rename(temp_path.c_str(), journal_path_.c_str()) != 0) {
+    if (fd >= 0) close(fd);
+    unlink(temp_path.c_str());
+    return;
+  }
+  close(journal_fd_);
+  journal_fd_ = fd;
+  unsynced_bytes_ = 0;
+  stats_.journal_bytes = total;
+  journal_torn_ = false;
+  journal_stale_ = false;
+
+  lock->unlock();
+  SyncParentDirectory(journal_path_);
+  lock->lock();
+}
+
+void SessionCache::SyncLoop() {
+  const auto interval = std::chrono::milliseconds(sync_interval_ms_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    sync_wake_.wait(lock, [this] {
+      return stopping_ || unsynced_bytes_ > 0 || compact_requested_;
+    });
+    if (stopping_) break;
+    if (compact_requested_) {
+      CompactJournal(&lock);
+      continue;
+    }
+    // Let further appends accumulate, then make them all durable at once.
+    sync_wake_.wait_for(lock, interval, [this] { return stopping_; });
+    if (stopping_ || unsynced_bytes_ == 0) continue;
+
+    int fd = dup(journal_fd_);
+    unsynced_bytes_ = 0;
+    lock.unlock();
+    // A compaction may swap the journal meanwhile; it syncs the new file
+    // itself, so syncing the old one through the duplicate is harmless.
+    bool synced = fd >= 0 && fdatasync(fd) == 0;
+    if (fd >= 0) close(fd);
+    lock.lock();
+    if (synced) ++stats_.journal_syncs;
+  }
+}
+
+}  // namespace prava
+
+void* prava_session_cache_open(const char* journal_path,
+                               uint32_t capacity,
+                               uint32_t sync_interval_ms) {
+  if (journal_path == nullptr) return nullptr;
+  return prava::SessionCache::Open(journal_path, capacity, sync_interval_ms)
+      .release();
+}
+
+int32_t prava_session_cache_get(void* cache,
+                                const uint8_t* key,
+                                uint32_t key_length,
+                                uint8_t* out,
+                                uint32_t out_capacity,
+                                uint32_t* length) {
+  if (cache == nullptr || key == nullptr || length == nullptr) return 0;
+  if (out == nullptr) out_capacity = 0;
+  return static_cast<prava::SessionCache*>(cache)->Get(
+      std::string(reinterpret_cast<const char*>(key), key_length), out,
+      out_capacity, length);
+}
+
+int32_t prava_session_cache_put(void* cache,
+                                const uint8_t* key,
+                                uint32_t key_length,
+                                const uint8_t* value,
+                                uint32_t value_length) {
+  if (cache == nullptr || key == nullptr) return 0;
+  if (value == nullptr && value_length != 0) return 0;
+  return static_cast<prava::SessionCache*>(cache)->Put(
+      std::string(reinterpret_cast<const char*>(key), key_length), value,
+      value_length);
+}
+
+int32_t prava_session_cache_prime(void* cache,
+                                  const uint8_t* key,
+                                  uint32_t key_length,
+                                  const uint8_t* value,
+                                  uint32_t value_length) {
+  if (cache == nullptr || key == nullptr) return 0;
+  if (value == nullptr && value_length != 0) return 0;
+  return static_cast<prava::SessionCache*>(cache)->Prime(
+      std::string(reinterpret_cast<const char*>(key), key_length), value,
+      value_length);
+}
+
+int32_t prava_session_cache_remove(void* cache,
+                                   const uint8_t* key,
+                                   uint32_t key_length) {
+  if (cache == nullptr || key == nullptr) return 0;
+  return static_cast<prava::SessionCache*>(cache)->Remove(
+      std::string(reinterpret_cast<const char*>(key), key_length));
+}
+
+int32_t prava_session_cache_clear(void* cache) {
+  if (cache == nullptr) return 0;
+  return static_cast<prava::SessionCache*>(cache)->Clear();
+}
+
+uint64_t prava_session_cache_take_dirty(void* cache,
+                                        uint8_t** out,
+                                        uint32_t* out_size,
+                                        uint32_t* count) {
+  if (cache == nullptr || out == nullptr || out_size == nullptr ||
+      count == nullptr) {
+    return 0;
+  }
+  size_t size = 0;
+  uint64_t generation =
+      static_cast<prava::SessionCache*>(cache)->TakeDirty(out, &size, count);
+  if (size > UINT32_MAX) {
+    sodium_free(*out);
+    *out = nullptr;
+    *count = 0;
+    return 0;
+  }
+  *out_size = static_cast<uint32_t>(size);
+  return generation;
+}
+
+void prava_session_cache_release(uint8_t* buffer) {
+  sodium_free(buffer);
+}
+
+int32_t prava_session_cache_checkpoint(void* cache, uint64_t generation) {
+  if (cache == nullptr) return 0;
+  return static_cast<prava::SessionCache*>(cache)->Checkpoint(generation);
+}
+
+void prava_session_cache_stats(void* cache, PravaSessionCacheStats* out) {
+  if (cache == nullptr || out == nullptr) return;
+  *out = static_cast<prava::SessionCache*>(cache)->Stats();
+}
+
+void prava_session_cache_close(void* cache) {
+  delete static_cast<prava::SessionCache*>(cache);
+}
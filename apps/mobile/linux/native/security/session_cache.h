@@ -0,0 +1,206 @@
+#ifndef PRAVA_NATIVE_SECURITY_SESSION_CACHE_H_
+#define PRAVA_NATIVE_SECURITY_SESSION_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/export.h"
+
+// Counters for one cache instance.
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t puts;
+  uint64_t evictions;
+  uint64_t journal_bytes;
+  uint64_t journal_syncs;
+  uint64_t checkpoints;
+  uint32_t entries;
+  uint32_t dirty;
+} PravaSessionCacheStats;
+
+#ifdef __cplusplus
+
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "common/secure_buffer.h"
+
+namespace prava {
+
+// Write-behind cache for encoded Double Ratchet session records.
+//
+// Hot sessions live in an LRU whose values are kept in guarded, mlocked
+// libsodium allocations and are overwritten in place on every ratchet step.
+// Each update is appended to a checksummed journal next to the vault, so an
+// app crash loses nothing; a background thread fdatasyncs the journal at most
+// once per |sync_interval_ms|, coalescing many steps into one durable write.
+//
+// Dart drains dirty records with TakeDirty(), writes them to Isar in a single
+// transaction and then calls Checkpoint() with the returned generation, which
+// marks them clean. Once the journal outgrows kCompactThreshold the sync
+// thread compacts it down to the still-dirty records, without blocking
+// readers and writers on the file I/O. On Open() the journal is
+// replayed; recovered records come back dirty so they reach Isar on the next
+// flush. A torn tail record is detected by its checksum and truncated.
+// A failed append is rolled back to the last good record, and the journal
+// is compacted from the cache so that a record it is missing (a put, or a
+// remove's tombstone) cannot be contradicted by older ones on replay.
+//
+// Dirty records are never evicted, so the cache may temporarily exceed
+// |capacity| between flushes.
+class SessionCache {
+ public:
+  // Journal size past which a checkpoint schedules a compaction.
+  static constexpr uint64_t kCompactThreshold = 1024 * 1024;
+
+  static std::unique_ptr<SessionCache> Open(const std::string& journal_path,
+                                            uint32_t capacity,
+                                            uint32_t sync_interval_ms);
+  ~SessionCache();
+
+  SessionCache(const SessionCache&) = delete;
+  SessionCache& operator=(const SessionCache&) = delete;
+
+  // Copies the record for |key| into |out| when it fits. Returns 1 on a hit
+  // (|length| set), 0 on a miss and -1 when |out_capacity| is too small
+  // (|length| set to the required size).
+  int Get(const std::string& key,
+          uint8_t* out,
+          uint32_t out_capacity,
+          uint32_t* length);
+
+  // Inserts or overwrites |key| and journals the change. Returns false if
+  // the record could not be made crash-safe; the caller should flush.
+  bool Put(const std::string& key, const uint8_t* value, uint32_t length);
+
+  // Caches a record just read from Isar. It starts clean and is not
+  // journaled; an existing entry (which may be newer) is left untouched.
+  bool Prime(const std::string& key, const uint8_t* value, uint32_t length);
+
+  // Drops |key| (including unflushed changes) and journals a tombstone.
+  // Returns false if the tombstone could not be written; flush as for Put.
+  bool Remove(const std::string& key);
+
+  // Drops every entry and empties the journal (vault cleared or restored).
+  bool Clear();
+
+  // Serializes every dirty record as
+  //   [key length : u32 LE][key][value length : u32 LE][value]
+  // into |out| (secure memory owned by the caller via sodium_free) and
+  // returns the generation to pass to Checkpoint().
+  uint64_t TakeDirty(uint8_t** out, size_t* out_size, uint32_t* count);
+
+  // Marks records written up to |generation| as persisted. Cheap: any
+  // compaction this makes due runs later on the sync thread.
+  bool Checkpoint(uint64_t generation);
+
+  PravaSessionCacheStats Stats();
+
+ private:
+  struct Entry;
+  using LruList = std::list<std::string>;
+
+  SessionCache(std::string journal_path,
+               uint32_t capacity,
+               uint32_t sync_interval_ms);
+
+  bool Recover();
+  bool AppendRecord(uint8_t type,
+                    const std::string& key,
+                    const uint8_t* value,
+                    uint32_t length,
+                    uint64_t sequence);
+  bool StoreLocked(const std::string& key,
+                   const uint8_t* value,
+                   uint32_t length,
+                   uint64_t dirty_sequence);
+  void EraseLocked(const std::string& key);
+  // Schedules a compaction after the journal missed a change.
+  void MarkJournalStaleLocked();
+  void EvictLocked();
+  // Rewrites the journal with the still-dirty records. Called on the sync
+  // thread with |lock| held; releases it around the file I/O.
+  void CompactJournal(std::unique_lock<std::mutex>* lock);
+  void SyncLoop();
+
+  const std::string journal_path_;
+  const uint32_t capacity_;
+  const uint32_t sync_interval_ms_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  LruList lru_;
+  int journal_fd_ = -1;
+  uint64_t sequence_ = 0;
+  uint64_t unsynced_bytes_ = 0;
+  PravaSessionCacheStats stats_ = {};
+
+  // Encoding space for AppendRecord(); wiped after every write.
+  SecureBuffer record_scratch_;
+  // Set when a failed write left bytes past |stats_.journal_bytes| that
+  // could not be truncated yet.
+  bool journal_torn_ = false;
+  // Set when the journal no longer matches the cache; cleared by the next
+  // compaction (or Clear()).
+  bool journal_stale_ = false;
+
+  // Compaction state. Records appended while a compaction writes the new
+  // file are also kept in |compaction_tail_| and copied over before the
+  // swap. Clear() and MarkJournalStaleLocked() bump |journal_epoch_| so an
+  // in-flight compaction is discarded instead of writing an outdated copy.
+  bool compact_requested_ = false;
+  bool compacting_ = false;
+  uint64_t journal_epoch_ = 0;
+  SecureBuffer compaction_tail_;
+
+  std::condition_variable sync_wake_;
+  bool stopping_ = false;
+  std::thread sync_thread_;
+};
+
+}  // namespace prava
+
+#endif  // __cplusplus
+
+// C ABI consumed by lib/security/bridge/native_session_cache.dart.
+PRAVA_EXPORT void* prava_session_cache_open(const char* journal_path,
+                                            uint32_t capacity,
+                                            uint32_t sync_interval_ms);
+PRAVA_EXPORT int32_t prava_session_cache_get(void* cache,
+                                             const uint8_t* key,
+                                             uint32_t key_length,
+                                             uint8_t* out,
+                                             uint32_t out_capacity,
+                                             uint32_t* length);
+PRAVA_EXPORT int32_t prava_session_cache_put(void* cache,
+                                             const uint8_t* key,
+                                             uint32_t key_length,
+                                             const uint8_t* value,
+                                             uint32_t value_length);
+PRAVA_EXPORT int32_t prava_session_cache_prime(void* cache,
+                                               const uint8_t* key,
+                                               uint32_t key_length,
+                                               const uint8_t* value,
+                                               uint32_t value_length);
+PRAVA_EXPORT int32_t prava_session_cache_remove(void* cache,
+                                                const uint8_t* key,
+                                                uint32_t key_length);
+PRAVA_EXPORT int32_t prava_session_cache_clear(void* cache);
+PRAVA_EXPORT uint64_t prava_session_cache_take_dirty(void* cache,
+                                                     uint8_t** out,
+                                                     uint32_t* out_size,
+                                                     uint32_t* count);
+PRAVA_EXPORT void prava_session_cache_release(uint8_t* buffer);
+PRAVA_EXPORT int32_t prava_session_cache_checkpoint(void* cache,
+                                                    uint64_t generation);
+PRAVA_EXPORT void prava_session_cache_stats(void* cache,
+                                            PravaSessionCacheStats* out);
+PRAVA_EXPORT void prava_session_cache_close(void* cache);
+
+#endif  // PRAVA_NATIVE_SECURITY_SESSION_CACHE_H_
@@ -0,0 +1,302 @@
+#include <gtest/gtest.h>
+
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "security/session_cache.h"
+
+namespace {
+
+constexpr uint32_t kCapacity = 64;
+constexpr uint32_t kSyncIntervalMs = 5;
+
+std::string Key(int index) { return "session:usr_" + std::to_string(index); }
+
+// Large enough that a few hundred puts pass SessionCache::kCompactThreshold.
+std::string Value(int index, int round) {
+  return std::to_string(round) + ":" + std::string(2000, 'a' + index % 26);
+}
+
+bool Put(void* cache, const std::string& key, const std::string& value) {
+  return prava_session_cache_put(
+             cache, reinterpret_cast<const uint8_t*>(key.data()),
+             static_cast<uint32_t>(key.size()),
+             reinterpret_cast<const uint8_t*>(value.data()),
+             static_cast<uint32_t>(value.size())) != 0;
+}
+
+bool Remove(void* cache, const std::string& key) {
+  return prava_session_cache_remove(
+             cache, reinterpret_cast<const uint8_t*>(key.data()),
+             static_cast<uint32_t>(key.size())) != 0;
+}
+
+// The cached record, or "<miss>".
+std::string Get(void* cache, const std::string& key) {
+  std::vector<uint8_t> out(8192);
+  uint32_t length = 0;
+  int32_t found = prava_session_cache_get(
+      cache, reinterpret_cast<const uint8_t*>(key.data()),
+      static_cast<uint32_t>(key.size()), out.data(),
+      static_cast<uint32_t>(out.size()), &length);
+  if (found != 1) return "<miss>";
+  return std::string(reinterpret_cast<const char*>(out.data()), length);
+}
+
+PravaSessionCacheStats Stats(void* cache) {
+  PravaSessionCacheStats stats;
+  prava_session_cache_stats(cache, &stats);
+  return stats;
+}
+
+// What SessionCache.flush() does once Isar has the records.
+void Flush(void* cache) {
+  uint8_t* dirty = nullptr;
+  uint32_t size = 0;
+  uint32_t count = 0;
+  uint64_t generation =
+      prava_session_cache_take_dirty(cache, &dirty, &size, &count);
+  prava_session_cache_release(dirty);
+  prava_session_cache_checkpoint(cache, generation);
+}
+
+// Polls until the sync thread has brought the journal under |bytes|.
+bool WaitForJournalBelow(void* cache, uint64_t bytes) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (Stats(cache).journal_bytes < bytes) return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return false;
+}
+
+// Makes writes past |limit| bytes fail (EFBIG) for the whole process, so
+// an append can be cut short the way a full disk cuts it.
+class FileSizeLimit {
+ public:
+  explicit FileSizeLimit(off_t limit) {
+    signal(SIGXFSZ, SIG_IGN);
+    getrlimit(RLIMIT_FSIZE, &saved_);
+    struct rlimit limited = saved_;
+    limited.rlim_cur = static_cast<rlim_t>(limit);
+    setrlimit(RLIMIT_FSIZE, &limited);
+  }
+  ~FileSizeLimit() { setrlimit(RLIMIT_FSIZE, &saved_); }
+
+ private:
+  struct rlimit saved_;
+};
+
+class SessionCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const char* root = getenv("TMPDIR");
+    std::string pattern =
+        std::string(root != nullptr && root[0] != '\0' ? root : "/tmp") +
+        "/prava-test-XXXXXX";
+    ASSERT_NE(mkdtemp(&pattern[0]), nullptr);
+    directory_ = pattern;
+    path_ = directory_ + "/sessions.journal";
+  }
+
+  void TearDown() override {
+    unlink(path_.c_str());
+    unlink((path_ + ".tmp").c_str());
+    rmdir(directory_.c_str());
+  }
+
+  void* Open() {
+    return prava_session_cache_open(path_.c_str(), kCapacity,
+                                    kSyncIntervalMs);
+  }
+
+  off_t FileSize() const {
+    struct stat info;
+    return stat(path_.c_str(), &info) == 0 ? info.st_size : -1;
+  }
+
+  void Truncate(off_t size) { ASSERT_EQ(truncate(path_.c_str(), size), 0); }
+
+  std::string directory_;
+  std::string path_;
+};
+
+TEST_F(SessionCacheTest, ReplaysJournalAsDirtyRecords) {
+  void* cache = Open();
+  ASSERT_NE(cache, nullptr);
+  ASSERT_TRUE(Put(cache, Key(1), Value(1, 0)));
+  ASSERT_TRUE(Put(cache, Key(2), Value(2, 0)));
+  ASSERT_TRUE(Put(cache, Key(1), Value(1, 1)));
+  prava_session_cache_close(cache);
+
+  cache = Open();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(Get(cache, Key(1)), Value(1, 1));
+  EXPECT_EQ(Get(cache, Key(2)), Value(2, 0));
+  EXPECT_EQ(Stats(cache).dirty, 2u);
+  EXPECT_EQ(Stats(cache).journal_bytes, static_cast<uint64_t>(FileSize()));
+  prava_session_cache_close(cache);
+}
+
+TEST_F(SessionCacheTest, TruncatesTornTailAndKeepsLaterAppends) {
+  void* cache = Open();
+  ASSERT_NE(cache, nullptr);
+  ASSERT_TRUE(Put(cache, Key(1), Value(1, 0)));
+  ASSERT_TRUE(Put(cache, Key(2), Value(2, 0)));
+  prava_session_cache_close(cache);
+  // A crash in the middle of the second record.
+  Truncate(FileSize() - 100);
+
+  cache = Open();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(Get(cache, Key(1)), Value(1, 0));
+  EXPECT_EQ(Get(cache, Key(2)), "<miss>");
+  EXPECT_EQ(Stats(cache).journal_bytes, static_cast<uint64_t>(FileSize()));
+  ASSERT_TRUE(Put(cache, Key(3), Value(3, 0)));
+  prava_session_cache_close(cache);
+
+  cache = Open();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(Get(cache, Key(1)), Value(1, 0));
+  EXPECT_EQ(Get(cache, Key(3)), Value(3, 0));
+  prava_session_cache_close(cache);
+}
+
+TEST_F(SessionCacheTest, RollsBackRecordCutShortMidFile) {
+  void* cache = Open();
+  ASSERT_NE(cache, nullptr);
+  ASSERT_TRUE(Put(cache, Key(1), Value(1, 0)));
+  const off_t good = FileSize();
+  {
+    // Room for half of the next record only.
+    FileSizeLimit limit(good + 1000);
+    EXPECT_FALSE(Put(cache, Key(2), Value(2, 0)));
+  }
+  // Rolled back to the last good record (or already compacted).
+  EXPECT_EQ(Stats(cache).journal_bytes, static_cast<uint64_t>(FileSize()));
+  // Appended after the failure: must not be stranded behind a partial
+  // record on replay.
+  ASSERT_TRUE(Put(cache, Key(3), Value(3, 0)));
+  prava_session_cache_close(cache);
+
+  cache = Open();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(Get(cache, Key(1)), Value(1, 0));
+  EXPECT_EQ(Get(cache, Key(3)), Value(3, 0));
+  prava_session_cache_close(cache);
+}
+
+TEST_F(SessionCacheTest, RemovedRecordStaysRemovedAfterReplay) {
+  void* cache = Open();
+  ASSERT_NE(cache, nullptr);
+  ASSERT_TRUE(Put(cache, Key(1), Value(1, 0)));
+  ASSERT_TRUE(Put(cache, Key(2), Value(2, 0)));
+  ASSERT_TRUE(Remove(cache, Key(1)));
+  EXPECT_EQ(Get(cache, Key(1)), "<miss>");
+  prava_session_cache_close(cache);
+
+  cache = Open();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(Get(cache, Key(1)), "<miss>");
+  EXPECT_EQ(Get(cache, Key(2)), Value(2, 0));
+  prava_session_cache_close(cache);
+}
+
+TEST_F(SessionCacheTest, FailedTombstoneIsCompactedAway) {
+  void* cache = Open();
+  ASSERT_NE(cache, nullptr);
+  ASSERT_TRUE(Put(cache, Key(1), Value(1, 0)));
+  ASSERT_TRUE(Put(cache, Key(2), Value(2, 0)));
+  Flush(cache);
+  ASSERT_TRUE(Put(cache, Key(2), Value(2, 1)));
+  const off_t before = FileSize();
+  {
+    FileSizeLimit limit(before);
+    EXPECT_FALSE(Remove(cache, Key(1)));
+  }
+  EXPECT_EQ(Get(cache, Key(1)), "<miss>");
+  // The compaction scheduled by the failure may itself have hit the limit;
+  // the next checkpoint retries it.
+  Flush(cache);
+  ASSERT_TRUE(WaitForJournalBelow(cache, static_cast<uint64_t>(before)));
+  prava_session_cache_close(cache);
+
+  cache = Open();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(Get(cache, Key(1)), "<miss>");
+  prava_session_cache_close(cache);
+}
+
+TEST_F(SessionCacheTest, CompactionKeepsAppendsRacingIt) {
+  void* cache = Open();
+  ASSERT_NE(cache, nullptr);
+  constexpr int kKeys = 50;
+  for (int round = 0; round < 12; ++round) {
+    for (int i = 0; i < kKeys; ++i) {
+      ASSERT_TRUE(Put(cache, Key(i), Value(i, round)));
+    }
+  }
+  const uint64_t before = Stats(cache).journal_bytes;
+  ASSERT_GE(before, prava::SessionCache::kCompactThreshold);
+
+  // Everything clean, then even keys rewritten while the sync thread
+  // compacts.
+  Flush(cache);
+  std::atomic<bool> ok(true);
+  std::thread writer([&] {
+    for (int r = 12; r < 15; ++r) {
+      for (int i = 0; i < kKeys; i += 2) {
+        if (!Put(cache, Key(i), Value(i, r))) ok = false;
+      }
+    }
+  });
+  writer.join();
+  ASSERT_TRUE(ok);
+  ASSERT_TRUE(WaitForJournalBelow(cache, before));
+  EXPECT_EQ(Stats(cache).journal_bytes, static_cast<uint64_t>(FileSize()));
+  prava_session_cache_close(cache);
+
+  cache = Open();
+  ASSERT_NE(cache, nullptr);
+  for (int i = 0; i < kKeys; i += 2) {
+    EXPECT_EQ(Get(cache, Key(i)), Value(i, 14));
+  }
+  // Odd keys were clean at the checkpoint and are no longer journaled.
+  EXPECT_EQ(Get(cache, Key(1)), "<miss>");
+  prava_session_cache_close(cache);
+}
+
+TEST_F(SessionCacheTest, ClearDuringCompactionDoesNotResurrectRecords) {
+  for (int attempt = 0; attempt < 10; ++attempt) {
+    void* cache = Open();
+    ASSERT_NE(cache, nullptr);
+    for (int round = 0; round < 12; ++round) {
+      for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(Put(cache, Key(i), Value(i, round)));
+      }
+    }
+    prava_session_cache_checkpoint(cache, 0);
+    std::this_thread::sleep_for(std::chrono::microseconds(attempt * 200));
+    ASSERT_TRUE(prava_session_cache_clear(cache));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    prava_session_cache_close(cache);
+
+    cache = Open();
+    ASSERT_NE(cache, nullptr);
+    EXPECT_EQ(Stats(cache).entries, 0u);
+    prava_session_cache_close(cache);
+  }
+}
+
+}  // namespace
@@ -6,6 +6,7 @@
 #endif
 
 #include "flutter/generated_plugin_registrant.h"
+#include "feed/feed_cache.h"
 
 struct _MyApplication {
   GtkApplication parent_instance;
@@ -19,9 +20,22 @@ static void first_frame_cb(MyApplication* self, FlView* view) {
   gtk_widget_show(gtk_widget_get_toplevel(GTK_WIDGET(view)));
 }
 
+// Starts reading the offline feed cache while the engine boots, so the
+// first Dart read of it is served from the page cache. The path matches
+// path_provider's application support directory plus FeedCache's file name.
+static void prefetch_feed_cache(GApplication* application) {
+  const gchar* application_id = g_application_get_application_id(application);
+  if (application_id == nullptr) return;
+  g_autofree gchar* path = g_build_filename(
+      g_get_user_data_dir(), application_id, "feed_cache.bin", nullptr);
+  prava_feed_cache_prefetch(path);
+}
+
 // Implements GApplication::activate.
 static void my_application_activate(GApplication* application) {
   MyApplication* self = MY_APPLICATION(application);
+  prefetch_feed_cache(application);
+
   GtkWindow* window =
       GTK_WINDOW(gtk_application_window_new(GTK_APPLICATION(application)));
 
@@ -232,24 +232,37 @@ class MessagesService {
     conversations: Array<{ conversationId: string; lastKnownSeq: number }>,
     limitPerConversation = 50
   ) {
-    const data = await apiClient.post<{ conversations?: Array<{
+    // The server syncs a bounded number of conversations per request and
+    // hands back the ids it did not get to in `remaining`.
+    const payload: Array<{
       conversationId: string;
       hasMore: boolean;
       currentSeq: number;
       updatedAt?: string | null;
       messages: BackendMessage[];
-    }> }>(
-      '/conversations/sync',
-      {
-        auth: true,
-        body: {
-          conversations,
-          limitPerConversation,
-        },
-      }
-    );
+    }> = [];
+    let pending = conversations;
+    while (pending.length > 0) {
+      const data = await apiClient.post<{
+        conversations?: typeof payload;
+        remaining?: string[];
+      }>(
+        '/conversations/sync',
+        {
+          auth: true,
+          body: {
+            conversations: pending,
+            limitPerConversation,
+          },
+        }
+      );
+      if (Array.isArray(data.conversations)) payload.push(...data.conversations);
+      const remaining = new Set(Array.isArray(data.remaining) ? data.remaining : []);
+      const next = pending.filter((item) => remaining.has(item.conversationId));
+      if (next.length >= pending.length) break;
+      pending = next;
+    }
 
-    const payload = Array.isArray(data.conversations) ? data.conversations : [];
     return payload.map((item) => ({
       conversationId: item.conversationId,
       hasMore: item.hasMore,